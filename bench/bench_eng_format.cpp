@@ -0,0 +1,383 @@
+// Copyright (C) 2013 by Martin Moene
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "eng_format.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+
+#if __cplusplus >= 201703L
+# include <charconv>
+#endif
+
+#ifdef ENG_FORMAT_HEADER_ONLY
+# define BENCH_BUILD "header-only"
+#else
+# define BENCH_BUILD "separately compiled"
+#endif
+
+namespace {
+
+typedef std::chrono::steady_clock clock_type;
+
+// keep the optimizer from discarding the work:
+volatile std::size_t sink;
+
+/*
+ * values and their engineering presentation for the parsing benchmarks.
+ */
+struct workload
+{
+    char const * name;
+    std::vector<double> values;
+    std::vector<std::string> texts;
+    std::vector<std::uint64_t> counts;
+};
+
+double log_uniform( std::mt19937_64 & generator )
+{
+    return std::pow( 10.0, std::uniform_real_distribution<double>( -24.0, 27.0 )( generator ) );
+}
+
+// readings around a few nominal levels, with noise and sign:
+double sensor_like( std::mt19937_64 & generator )
+{
+    static const double nominal[] = { 3.3, 12.0, 0.047, 1.5e-6, 230.0, 4.7e3 };
+
+    const double level = nominal[ generator() % ( sizeof nominal / sizeof nominal[0] ) ];
+    const double noise = std::normal_distribution<double>( 1.0, 0.02 )( generator );
+
+    return ( generator() % 8 ? +1 : -1 ) * level * noise;
+}
+
+// 999.5 x 10^3k, where rounding carries into the next prefix:
+double boundary_heavy( std::mt19937_64 & generator )
+{
+    const int    degree = static_cast<int>( generator() % 17 ) - 8;
+    const double offset = std::uniform_real_distribution<double>( -0.01, 0.01 )( generator );
+
+    return ( 999.5 + offset ) * std::pow( 1000.0, degree );
+}
+
+// mostly regular values with a share of NaN and infinity:
+double special_mix( std::mt19937_64 & generator )
+{
+    switch ( generator() % 8 )
+    {
+    case 0:  return std::numeric_limits<double>::quiet_NaN();
+    case 1:  return +std::numeric_limits<double>::infinity();
+    case 2:  return -std::numeric_limits<double>::infinity();
+    default: return log_uniform( generator );
+    }
+}
+
+workload make_workload( char const * const name, double (*generate)( std::mt19937_64 & ), std::size_t const count )
+{
+    std::mt19937_64 generator( 42 );
+    workload result = { name, std::vector<double>( count ), std::vector<std::string>( count ), std::vector<std::uint64_t>( count ) };
+
+    for ( std::size_t i = 0; i < count; ++i )
+    {
+        result.values[i] = generate( generator );
+        result.texts[i]  = to_engineering_string( result.values[i], 4, eng_prefixed );
+
+        // as byte counts:
+        const double magnitude = std::fabs( result.values[i] );
+        result.counts[i] = magnitude < 1.8e19 ? static_cast<std::uint64_t>( magnitude ) : 0;
+    }
+    return result;
+}
+
+/*
+ * best of a few runs over all values of the workload.
+ */
+template <typename F>
+void measure( char const * const name, workload const & work, F f )
+{
+    const std::size_t count = work.values.size();
+
+    double best = std::numeric_limits<double>::max();
+
+    for ( int run = 0; run < 3; ++run )
+    {
+        const clock_type::time_point start = clock_type::now();
+
+        std::size_t total = 0;
+        for ( std::size_t i = 0; i < count; ++i )
+        {
+            total += f( work, i );
+        }
+
+        const double ns = std::chrono::duration<double, std::nano>( clock_type::now() - start ).count();
+
+        sink = total;
+        best = (std::min)( best, ns / count );
+    }
+
+    std::printf( "%-38s %-16s %8.1f ns/op %12.0f ops/s\n", name, work.name, best, 1e9 / best );
+}
+
+char buffer[ 64 ];
+
+std::size_t format_string( workload const & work, std::size_t const i )
+{
+    return to_engineering_string( work.values[i], 3, eng_prefixed ).size();
+}
+
+#if ENG_FORMAT_HAVE_PMR
+// a per-request arena on the stack:
+std::size_t format_pmr_string( workload const & work, std::size_t const i )
+{
+    char arena[ 128 ];
+    std::pmr::monotonic_buffer_resource resource( arena, sizeof arena, std::pmr::null_memory_resource() );
+
+    return to_engineering_string( &resource, work.values[i], 3, eng_prefixed ).size();
+}
+#endif
+
+std::size_t format_chars( workload const & work, std::size_t const i )
+{
+    return to_engineering_chars( buffer, sizeof buffer, work.values[i], 3, eng_prefixed );
+}
+
+std::size_t format_chars_exponential( workload const & work, std::size_t const i )
+{
+    return to_engineering_chars( buffer, sizeof buffer, work.values[i], 3, eng_exponential );
+}
+
+std::size_t format_chars_float( workload const & work, std::size_t const i )
+{
+    return to_engineering_chars( buffer, sizeof buffer, static_cast<float>( work.values[i] ), 3, eng_prefixed );
+}
+
+std::size_t format_chars_binary( workload const & work, std::size_t const i )
+{
+    return to_engineering_chars( buffer, sizeof buffer, work.values[i], 3, eng_binary );
+}
+
+std::size_t format_chars_binary_integer( workload const & work, std::size_t const i )
+{
+    return to_engineering_chars( buffer, sizeof buffer, work.counts[i], 3, eng_binary );
+}
+
+std::size_t format_chars_integer( workload const & work, std::size_t const i )
+{
+    return to_engineering_chars( buffer, sizeof buffer, work.counts[i], 3, eng_prefixed );
+}
+
+std::size_t format_chars_duration( workload const & work, std::size_t const i )
+{
+    return to_engineering_chars( buffer, sizeof buffer, std::chrono::nanoseconds( static_cast<long long>( work.counts[i] / 2 ) ), 3, eng_prefixed );
+}
+
+// as latencies were formatted before, in double seconds:
+std::size_t format_chars_duration_double( workload const & work, std::size_t const i )
+{
+    const std::chrono::nanoseconds latency( static_cast<long long>( work.counts[i] / 2 ) );
+
+    return to_engineering_chars( buffer, sizeof buffer, std::chrono::duration<double>( latency ).count(), 3, eng_prefixed, "s" );
+}
+
+std::size_t parse_string( workload const & work, std::size_t const i )
+{
+    return from_engineering_string( work.texts[i] ) > 0;
+}
+
+std::size_t parse_chars( workload const & work, std::size_t const i )
+{
+    return from_engineering_chars( work.texts[i].c_str() ) > 0;
+}
+
+std::size_t parse_chars_float( workload const & work, std::size_t const i )
+{
+    return from_engineering_chars<float>( work.texts[i].c_str() ) > 0;
+}
+
+std::size_t step_string( workload const & work, std::size_t const i )
+{
+    return step_engineering_string( work.texts[i], 3, eng_prefixed, eng_increment ).size();
+}
+
+std::size_t step_chars( workload const & work, std::size_t const i )
+{
+    return step_engineering_chars( buffer, sizeof buffer, work.texts[i].c_str(), 3, eng_prefixed, eng_increment );
+}
+
+// per value, the vector kernel running over blocks of 256 values:
+std::size_t max_magnitude( workload const & work, std::size_t const i )
+{
+    const std::size_t block = 256;
+
+    return i % block ? 0 : eng_max_magnitude( &work.values[i], (std::min)( block, work.values.size() - i ) ) > 0;
+}
+
+// per value, both passes of a column over blocks of 256 values:
+std::size_t format_column( workload const & work, std::size_t const i )
+{
+    const std::size_t block = 256;
+    static char text[ block * 64 ];
+
+    if ( i % block )
+    {
+        return 0;
+    }
+
+    const std::size_t count = (std::min)( block, work.values.size() - i );
+    const eng_column_t column = eng_column( &work.values[i], count, 3, false );
+
+    return to_engineering_column( text, sizeof text, &work.values[i], count, column, false );
+}
+
+std::size_t axis_ticks( workload const & work, std::size_t const i )
+{
+    double values[ 32 ];
+    static char text[ 32 * 64 ];
+
+    return eng_axis_ticks( 0, std::fabs( work.values[i] ), 6, false, values, 32, text, sizeof text ).length;
+}
+
+// a channel that gets a value of its own at each reading:
+std::size_t display( workload const & work, std::size_t const i )
+{
+    static eng_display_t channel = eng_display( 3, 0.01, false );
+
+    return to_engineering_display( buffer, sizeof buffer, channel, work.values[i] );
+}
+
+// a channel that stays at each value for 64 readings, drifting up to 1%:
+std::size_t display_steady( workload const & work, std::size_t const i )
+{
+    static eng_display_t channel = eng_display( 3, 0.01, false );
+
+    return to_engineering_display( buffer, sizeof buffer, channel, work.values[ i - i % 64 ] * ( 1 + 1.5e-4 * ( i % 64 ) ) );
+}
+
+std::size_t key( workload const & work, std::size_t const i )
+{
+    return static_cast<std::size_t>( eng_key( work.values[i], 3 ).mantissa );
+}
+
+std::size_t parts( workload const & work, std::size_t const i )
+{
+    return static_cast<std::size_t>( eng_parts( work.values[i], 3, false ).count );
+}
+
+std::size_t normalize_chars( workload const & work, std::size_t const i )
+{
+    return normalize_engineering_chars( buffer, sizeof buffer, work.texts[i].c_str(), 3, false );
+}
+
+std::size_t parse_and_format( workload const & work, std::size_t const i )
+{
+    return to_engineering_chars( buffer, sizeof buffer, from_engineering_chars( work.texts[i].c_str() ), 3, false );
+}
+
+std::size_t sort_key( workload const & work, std::size_t const i )
+{
+    return eng_sort_key( work.texts[i].c_str() ).bytes[0];
+}
+
+// the cost on the logging thread; the background thread renders and discards:
+std::size_t deferred_log( workload const & work, std::size_t const i )
+{
+    static eng_logger logger( []( int, char const *, std::size_t ) {}, 1 << 16 );
+    static const int format = logger.add_format( 3, false );
+
+    return logger.log( format, work.values[i] );
+}
+
+std::size_t baseline_snprintf( workload const & work, std::size_t const i )
+{
+    return std::snprintf( buffer, sizeof buffer, "%.*e", 2, work.values[i] );
+}
+
+#if defined( __cpp_lib_to_chars )
+std::size_t baseline_to_chars( workload const & work, std::size_t const i )
+{
+    return std::to_chars( buffer, buffer + sizeof buffer, work.values[i], std::chars_format::scientific, 2 ).ptr - buffer;
+}
+#endif
+
+} // anonymous namespace
+
+int main( int argc, char * argv[] )
+{
+    const std::size_t count = argc > 1 ? std::strtoul( argv[1], NULL, 10 ) : 200000;
+
+    std::vector<workload> workloads;
+    workloads.push_back( make_workload( "log-uniform"   , log_uniform   , count ) );
+    workloads.push_back( make_workload( "sensor-like"   , sensor_like   , count ) );
+    workloads.push_back( make_workload( "boundary-heavy", boundary_heavy, count ) );
+    workloads.push_back( make_workload( "nan-inf-mix"   , special_mix   , count ) );
+
+    std::printf( "eng_format benchmark, " BENCH_BUILD ", %u values per workload, %s vector kernels:\n\n", static_cast<unsigned>( count ), eng_format_isa() );
+
+    for ( std::size_t w = 0; w < workloads.size(); ++w )
+    {
+        workload const & work = workloads[w];
+
+        measure( "to_engineering_string( prefixed )"  , work, format_string );
+#if ENG_FORMAT_HAVE_PMR
+        measure( "to_engineering_string( std::pmr )"  , work, format_pmr_string );
+#endif
+        measure( "to_engineering_chars( prefixed )"   , work, format_chars );
+        measure( "to_engineering_chars( exponential )", work, format_chars_exponential );
+        measure( "to_engineering_chars( float )"      , work, format_chars_float );
+        measure( "to_engineering_chars( binary )"     , work, format_chars_binary );
+        measure( "to_engineering_chars( uint64, binary )", work, format_chars_binary_integer );
+        measure( "to_engineering_chars( uint64 )"     , work, format_chars_integer );
+        measure( "to_engineering_chars( nanoseconds )", work, format_chars_duration );
+        measure( "to_engineering_chars( double s )"   , work, format_chars_duration_double );
+        measure( "from_engineering_string()"          , work, parse_string );
+        measure( "from_engineering_chars()"           , work, parse_chars );
+        measure( "from_engineering_chars<float>()"    , work, parse_chars_float );
+        measure( "step_engineering_string()"          , work, step_string );
+        measure( "step_engineering_chars()"           , work, step_chars );
+        measure( "eng_max_magnitude(), per value"     , work, max_magnitude );
+        measure( "to_engineering_column(), per value" , work, format_column );
+        measure( "eng_axis_ticks(), 6 ticks"          , work, axis_ticks );
+        measure( "to_engineering_display()"           , work, display );
+        measure( "to_engineering_display(), steady"   , work, display_steady );
+        measure( "eng_key()"                          , work, key );
+        measure( "eng_parts()"                        , work, parts );
+        measure( "normalize_engineering_chars()"      , work, normalize_chars );
+        measure( "from_ and to_engineering_chars()"   , work, parse_and_format );
+        measure( "eng_sort_key()"                     , work, sort_key );
+        measure( "eng_logger::log()"                  , work, deferred_log );
+        measure( "baseline: snprintf( \"%.*e\" )"     , work, baseline_snprintf );
+#if defined( __cpp_lib_to_chars )
+        measure( "baseline: std::to_chars( scientific )", work, baseline_to_chars );
+#endif
+        std::printf( "\n" );
+    }
+
+    return 0;
+}
+
+// g++ -O2 -std=c++17 -pthread -I../src -o bench_eng_format bench_eng_format.cpp ../src/eng_format.cpp && bench_eng_format [count]
+// g++ -O2 -std=c++17 -pthread -DENG_FORMAT_HEADER_ONLY -I../src -o bench_eng_format_header_only bench_eng_format.cpp && bench_eng_format_header_only [count]
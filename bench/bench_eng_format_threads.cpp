@@ -0,0 +1,204 @@
+// Copyright (C) 2013 by Martin Moene
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+// Thread scaling: run 1 to all cores concurrently formatting and parsing,
+// and report throughput and per-call latency percentiles. The original
+// std::ostringstream-based implementation is included for comparison: it
+// touches the shared global locale on every call.
+//
+//   bench_eng_format_threads [calls-per-thread [max-threads]]
+
+#include "eng_format.hpp"
+#include "../test/eng_format_reference.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+typedef std::chrono::steady_clock clock_type;
+
+// keep the optimizer from discarding the work:
+std::atomic<std::size_t> sink;
+
+/*
+ * per thread: its own values and texts, and room for the latencies.
+ */
+struct lane
+{
+    std::vector<double> values;
+    std::vector<std::string> texts;
+    std::vector<float> latencies;
+};
+
+lane make_lane( std::size_t const count, unsigned const seed )
+{
+    std::mt19937_64 generator( seed );
+    lane result = { std::vector<double>( count ), std::vector<std::string>( count ), std::vector<float>( count ) };
+
+    for ( std::size_t i = 0; i < count; ++i )
+    {
+        result.values[i] = std::pow( 10.0, std::uniform_real_distribution<double>( -24.0, 27.0 )( generator ) );
+        result.texts[i]  = to_engineering_string( result.values[i], 4, eng_prefixed );
+    }
+    return result;
+}
+
+std::size_t original_format( lane const & work, std::size_t const i )
+{
+    return eng_format_reference::to_engineering_string( work.values[i], 3, false ).size();
+}
+
+std::size_t format_string( lane const & work, std::size_t const i )
+{
+    return to_engineering_string( work.values[i], 3, eng_prefixed ).size();
+}
+
+std::size_t format_chars( lane const & work, std::size_t const i )
+{
+    char buffer[ 64 ];
+    return to_engineering_chars( buffer, sizeof buffer, work.values[i], 3, eng_prefixed );
+}
+
+std::size_t original_parse( lane const & work, std::size_t const i )
+{
+    return eng_format_reference::from_engineering_string( work.texts[i] ) > 0;
+}
+
+std::size_t parse_chars( lane const & work, std::size_t const i )
+{
+    return from_engineering_chars( work.texts[i].c_str() ) > 0;
+}
+
+typedef std::size_t (*operation)( lane const &, std::size_t );
+
+void run_lane( lane & work, operation const op, std::atomic<unsigned> & ready, unsigned const threads )
+{
+    // start together:
+    ready.fetch_add( 1 );
+    while ( ready.load() < threads )
+    {
+        std::this_thread::yield();
+    }
+
+    std::size_t total = 0;
+
+    for ( std::size_t i = 0; i < work.values.size(); ++i )
+    {
+        const clock_type::time_point start = clock_type::now();
+        total += op( work, i );
+        work.latencies[i] = std::chrono::duration<float, std::nano>( clock_type::now() - start ).count();
+    }
+
+    sink.fetch_add( total, std::memory_order_relaxed );
+}
+
+float percentile( std::vector<float> & latencies, double const fraction )
+{
+    const std::size_t n = static_cast<std::size_t>( fraction * ( latencies.size() - 1 ) );
+
+    std::nth_element( latencies.begin(), latencies.begin() + n, latencies.end() );
+    return latencies[n];
+}
+
+void measure( char const * const name, std::vector<lane> & lanes, unsigned const threads, operation const op )
+{
+    std::atomic<unsigned> ready( 0 );
+    std::vector<std::thread> pool;
+
+    const clock_type::time_point start = clock_type::now();
+
+    for ( unsigned t = 0; t < threads; ++t )
+    {
+        pool.push_back( std::thread( run_lane, std::ref( lanes[t] ), op, std::ref( ready ), threads ) );
+    }
+    for ( unsigned t = 0; t < threads; ++t )
+    {
+        pool[t].join();
+    }
+
+    const double seconds = std::chrono::duration<double>( clock_type::now() - start ).count();
+
+    std::vector<float> latencies;
+    for ( unsigned t = 0; t < threads; ++t )
+    {
+        latencies.insert( latencies.end(), lanes[t].latencies.begin(), lanes[t].latencies.end() );
+    }
+
+    const double calls = static_cast<double>( latencies.size() );
+
+    std::printf( "%-33s %3u threads %12.0f ops/s %8.1f p50 %8.1f p99 %8.1f p999 ns\n",
+        name, threads, calls / seconds,
+        percentile( latencies, 0.5 ), percentile( latencies, 0.99 ), percentile( latencies, 0.999 ) );
+}
+
+} // anonymous namespace
+
+int main( int argc, char * argv[] )
+{
+    const std::size_t count   = argc > 1 ? std::strtoul( argv[1], NULL, 10 ) : 100000;
+    const unsigned    cores   = (std::max)( 1u, std::thread::hardware_concurrency() );
+    const unsigned    maximum = argc > 2 ? std::strtoul( argv[2], NULL, 10 ) : cores;
+
+    std::vector<unsigned> thread_counts;
+    for ( unsigned n = 1; n < maximum; n *= 2 )
+    {
+        thread_counts.push_back( n );
+    }
+    thread_counts.push_back( maximum );
+
+    std::vector<lane> lanes;
+    for ( unsigned t = 0; t < maximum; ++t )
+    {
+        lanes.push_back( make_lane( count, 42 + t ) );
+    }
+
+    std::printf( "eng_format thread scaling, %u calls per thread, %u cores:\n\n", static_cast<unsigned>( count ), cores );
+
+    struct { char const * name; operation op; } const operations[] =
+    {
+        { "original to_engineering_string"  , original_format },
+        { "to_engineering_string()"       , format_string },
+        { "to_engineering_chars()"        , format_chars },
+        { "original from_engineering_string", original_parse },
+        { "from_engineering_chars()"      , parse_chars },
+    };
+
+    for ( std::size_t k = 0; k < sizeof operations / sizeof operations[0]; ++k )
+    {
+        for ( std::size_t n = 0; n < thread_counts.size(); ++n )
+        {
+            measure( operations[k].name, lanes, thread_counts[n], operations[k].op );
+        }
+        std::printf( "\n" );
+    }
+
+    return 0;
+}
+
+// g++ -O2 -std=c++17 -pthread -I../src -o bench_eng_format_threads bench_eng_format_threads.cpp ../src/eng_format.cpp ../test/eng_format_reference.cpp && bench_eng_format_threads [calls-per-thread [max-threads]]
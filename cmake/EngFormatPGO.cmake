@@ -0,0 +1,69 @@
+# Copyright (C) 2013 by Martin Moene
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in
+# all copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+# THE SOFTWARE.
+
+# Two-stage profile-guided optimization build, trained on the benchmark
+# workloads:
+#
+#   cmake [-DBUILD_DIR=build-pgo] [-DOPTIONS="-DENG_FORMAT_LTO=ON;-DENG_FORMAT_O3=ON"] -P cmake/EngFormatPGO.cmake
+#
+# Stage 1 builds an instrumented library and benchmarks and runs them to
+# collect the profile; stage 2 rebuilds in the same directory using it.
+# Compare bench_eng_format with that of a build without PGO to see the gain.
+
+get_filename_component( SOURCE_DIR "${CMAKE_CURRENT_LIST_DIR}/.." ABSOLUTE )
+
+if ( NOT BUILD_DIR )
+    set( BUILD_DIR "${SOURCE_DIR}/build-pgo" )
+endif()
+
+get_filename_component( BUILD_DIR "${BUILD_DIR}" ABSOLUTE )
+set( PGO_DIR "${BUILD_DIR}/pgo" )
+
+function( run )
+    execute_process( COMMAND ${ARGN} RESULT_VARIABLE result )
+    if ( result )
+        message( FATAL_ERROR "failed: ${ARGN}" )
+    endif()
+endfunction()
+
+file( REMOVE_RECURSE "${PGO_DIR}" )
+
+foreach( stage GENERATE USE )
+    message( STATUS "EngFormat PGO: stage ${stage}" )
+
+    run( ${CMAKE_COMMAND} -S "${SOURCE_DIR}" -B "${BUILD_DIR}"
+        -DCMAKE_BUILD_TYPE=Release
+        -DENG_FORMAT_BUILD_TESTS=OFF
+        -DENG_FORMAT_BUILD_EXAMPLES=OFF
+        -DENG_FORMAT_BUILD_BENCH=ON
+        -DENG_FORMAT_PGO=${stage}
+        -DENG_FORMAT_PGO_DIR=${PGO_DIR}
+        ${OPTIONS}
+    )
+    run( ${CMAKE_COMMAND} --build "${BUILD_DIR}" )
+
+    if ( stage STREQUAL "GENERATE" )
+        run( ${CMAKE_COMMAND} --build "${BUILD_DIR}" --target pgo_train )
+    endif()
+endforeach()
+
+message( STATUS "EngFormat PGO: done, see ${BUILD_DIR}" )
+
+# end of file
@@ -22,14 +22,50 @@
 
 #include "eng_format.hpp"
 
-#include <iomanip>
+#include <algorithm>
 #include <limits>
-#include <sstream>
 
 #include <ctype.h>
 #include <float.h>
 #include <math.h>
+#include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+
+#if __cplusplus >= 201703L
+# include <charconv>
+#endif
+
+#if ENG_FORMAT_CPP11
+# include <atomic>
+# include <condition_variable>
+# include <mutex>
+# include <thread>
+# include <utility>
+# include <vector>
+#endif
+
+/*
+ * Note: vector kernels have a variant per x86 instruction set; the widest
+ * one the CPU supports is chosen at the first call, see eng_format_isa().
+ * Define ENG_FORMAT_NO_DISPATCH to only use the portable variant.
+ */
+#ifndef ENG_FORMAT_DISPATCH
+# if !defined( ENG_FORMAT_NO_DISPATCH ) && ( defined( __x86_64__ ) || defined( __i386__ ) ) && \
+    ( ( defined( __clang__ ) && __clang_major__ >= 4 ) || ( !defined( __clang__ ) && defined( __GNUC__ ) && __GNUC__ >= 7 ) )
+#  define ENG_FORMAT_DISPATCH  1
+# else
+#  define ENG_FORMAT_DISPATCH  0
+# endif
+#endif
+
+#if ENG_FORMAT_DISPATCH
+# include <immintrin.h>
+#endif
+
+#if defined( _MSC_VER ) && defined( _M_X64 )
+# include <intrin.h>
+#endif
 
 /*
  * Note: using fabs() and other math functions in global namespace for
@@ -37,10 +73,46 @@
  */
 
 /*
- * Note: micro, , may not work everywhere, so you can define a glyph yourself:
+ * Note: digits are generated by std::to_chars() where available (C++17),
+ * otherwise by snprintf(); both round correctly and do not allocate.
+ * std::to_chars() also does not consult the locale, so that concurrent
+ * formatting shares no mutable or reference-counted state.
+ */
+#ifndef ENG_FORMAT_HAVE_TO_CHARS
+# if defined( __cpp_lib_to_chars )
+#  define ENG_FORMAT_HAVE_TO_CHARS  1
+# else
+#  define ENG_FORMAT_HAVE_TO_CHARS  0
+# endif
+#endif
+
+#if defined( _MSC_VER ) && _MSC_VER < 1900
+# define snprintf  _snprintf
+#endif
+
+#if ENG_FORMAT_STATS
+# include <atomic>
+# include <mutex>
+#endif
+
+/*
+ * Note: define ENG_FORMAT_TRACE to place USDT probes (sys/sdt.h) at entry
+ * and return of to_engineering_chars() and from_engineering_chars(), e.g.
+ * for perf or bpftrace: usdt:./program:eng_format:to_engineering_entry.
  */
-#ifndef ENG_FORMAT_MICRO_GLYPH
-# define ENG_FORMAT_MICRO_GLYPH ""
+#ifdef ENG_FORMAT_TRACE
+# include <sys/sdt.h>
+# define ENG_FORMAT_PROBE1( name, a )        DTRACE_PROBE1( eng_format, name, a )
+# define ENG_FORMAT_PROBE3( name, a, b, c )  DTRACE_PROBE3( eng_format, name, a, b, c )
+#else
+# define ENG_FORMAT_PROBE1( name, a )
+# define ENG_FORMAT_PROBE3( name, a, b, c )
+#endif
+
+#if ENG_FORMAT_STATS
+# define ENG_FORMAT_COUNT( counter )  eng_format_detail::count( eng_format_detail::counter )
+#else
+# define ENG_FORMAT_COUNT( counter )
 #endif
 
 /*
@@ -50,43 +122,62 @@
  */
 #define ENG_FORMAT_DIMENSION_OF(a) ( static_cast<int>( sizeof(a) / sizeof(0[a]) ) )
 
+#ifndef ENG_FORMAT_HEADER_ONLY
 eng_prefixed_t eng_prefixed;
 eng_exponential_t eng_exponential;
+eng_binary_t eng_binary;
+#endif
 
-namespace
+namespace eng_format_detail
 {
 
-char const * const prefixes[/*exp*/][2][9] =
+/*
+ * Note: the tables are function-local statics, returned by reference, so
+ * that with ENG_FORMAT_HEADER_ONLY each is one object in all translation
+ * units that use the inline functions, as the one definition rule requires.
+ */
+enum table_size { binary_prefix_count = 9 };
+
+/*
+ * IEC binary prefixes, for degrees of 1024.
+ */
+typedef char const * const binary_prefix_table[ binary_prefix_count ];
+
+ENG_FORMAT_INLINE binary_prefix_table & binary_prefixes()
 {
+    static binary_prefix_table table =
     {
-        {   "",   "m",   ENG_FORMAT_MICRO_GLYPH
-                            ,   "n",    "p",    "f",    "a",    "z",    "y", },
-        {   "",   "k",   "M",   "G",    "T",    "P",    "E",    "Z",    "Y", },
-    },
-    {
-        { "e0", "e-3", "e-6", "e-9", "e-12", "e-15", "e-18", "e-21", "e-24", },
-        { "e0",  "e3",  "e6",  "e9",  "e12",  "e15",  "e18",  "e21",  "e24", },
-    },
-};
+        "", "Ki", "Mi", "Gi", "Ti", "Pi", "Ei", "Zi", "Yi",
+    };
+    return table;
+}
+
+/*
+ * pow( 1000.0, degree ) for the degrees that have a prefix.
+ */
+typedef const double thousands_table[ 2 * prefix_count - 1 ];
 
-const int prefix_count = ENG_FORMAT_DIMENSION_OF( prefixes[false][false]  );
+ENG_FORMAT_INLINE thousands_table & powers_of_thousand()
+{
+    static thousands_table table =
+    {
+        1e-24, 1e-21, 1e-18, 1e-15, 1e-12, 1e-9, 1e-6, 1e-3,
+        1e0, 1e3, 1e6, 1e9, 1e12, 1e15, 1e18, 1e21, 1e24,
+    };
+    return table;
+}
 
 #if defined( _MSC_VER )
 
 template <typename T>
-long lrint( T const x )
+ENG_FORMAT_INLINE long lrint( T const x )
 {
     return static_cast<long>( x );
 }
 
 #endif
 
-int sign( int const value )
-{
-    return value == 0 ? +1 : value / abs( value );
-}
-
-bool is_zero( double const value )
+ENG_FORMAT_INLINE bool is_zero( double const value )
 {
 #if __cplusplus >= 201103L
     return FP_ZERO == fpclassify( value );
@@ -96,7 +187,7 @@ bool is_zero( double const value )
 #endif
 }
 
-bool is_nan( double const value )
+ENG_FORMAT_INLINE bool is_nan( double const value )
 {
 #if __cplusplus >= 201103L
     return isnan( value );
@@ -106,7 +197,7 @@ bool is_nan( double const value )
 #endif
 }
 
-bool is_inf( double const value )
+ENG_FORMAT_INLINE bool is_inf( double const value )
 {
 #if __cplusplus >= 201103L
     return isinf( value );
@@ -116,32 +207,332 @@ bool is_inf( double const value )
 #endif
 }
 
-long degree_of( double const value )
+ENG_FORMAT_INLINE bool is_negative( double const value )
+{
+#if __cplusplus >= 201103L
+    return signbit( value );
+#else
+    // deliberately ignore the sign of zero:
+    return value < 0.0;
+#endif
+}
+
+ENG_FORMAT_INLINE int clamp_digits( int const digits )
+{
+    return digits < 1 ? 1 : digits > eng_max_digits ? eng_max_digits : digits;
+}
+
+/*
+ * digits and exponent of "d.ddd...de-308".
+ */
+ENG_FORMAT_INLINE void read_decimal( char const * const text, bool const negative, decimal & result )
+{
+    result.negative = negative;
+    result.count    = 0;
+
+    // skip the decimal point, whatever the locale makes it:
+    char const * pos = text;
+    for ( ; *pos && 'e' != *pos; ++pos )
+    {
+        if ( '0' <= *pos && *pos <= '9' )
+        {
+            result.digits[ result.count++ ] = *pos;
+        }
+    }
+    result.exponent = *pos ? atoi( pos + 1 ) : 0;
+}
+
+/*
+ * correctly rounded conversion to count significant digits, 1 <= count <= eng_max_digits.
+ */
+ENG_FORMAT_INLINE void to_decimal( double const value, int const count, decimal & result )
+{
+    // "d.ddd...de-308":
+    char text[ eng_max_digits + 16 ];
+
+#if ENG_FORMAT_HAVE_TO_CHARS
+    *std::to_chars( text, text + sizeof text - 1, fabs( value ), std::chars_format::scientific, count - 1 ).ptr = '\0';
+#else
+    snprintf( text, sizeof text, "%.*e", count - 1, fabs( value ) );
+#endif
+
+    read_decimal( text, is_negative( value ), result );
+}
+
+#if ENG_FORMAT_CPP11
+
+ENG_FORMAT_INLINE bool is_nan( long double const value )
+{
+    return isnan( value );
+}
+
+ENG_FORMAT_INLINE bool is_inf( long double const value )
+{
+    return isinf( value );
+}
+
+ENG_FORMAT_INLINE bool is_negative( long double const value )
+{
+    return signbit( value );
+}
+
+/*
+ * as to_decimal() for double; std::to_chars() for float works on 32 bits,
+ * with smaller tables. Widening to double is exact, so snprintf() gives the
+ * same digits.
+ */
+ENG_FORMAT_INLINE void to_decimal( float const value, int const count, decimal & result )
+{
+    char text[ eng_max_digits + 16 ];
+
+#if ENG_FORMAT_HAVE_TO_CHARS
+    *std::to_chars( text, text + sizeof text - 1, fabs( value ), std::chars_format::scientific, count - 1 ).ptr = '\0';
+#else
+    snprintf( text, sizeof text, "%.*e", count - 1, static_cast<double>( fabs( value ) ) );
+#endif
+
+    read_decimal( text, is_negative( value ), result );
+}
+
+/*
+ * as to_decimal() for double, from all bits of the long double: "d.ddd...de-4951".
+ */
+ENG_FORMAT_INLINE void to_decimal( long double const value, int const count, decimal & result )
+{
+    char text[ eng_max_digits + 16 ];
+
+#if ENG_FORMAT_HAVE_TO_CHARS
+    *std::to_chars( text, text + sizeof text - 1, fabs( value ), std::chars_format::scientific, count - 1 ).ptr = '\0';
+#else
+    snprintf( text, sizeof text, "%.*Le", count - 1, fabs( value ) );
+#endif
+
+    read_decimal( text, is_negative( value ), result );
+}
+
+#endif // ENG_FORMAT_CPP11
+
+/*
+ * the digits of to_decimal(), for engineering_decimal().
+ */
+struct runtime_digits
+{
+    template< typename T >
+    static void convert( T const value, int const count, decimal & result )
+    {
+        to_decimal( value, count, result );
+    }
+};
+
+/*
+ * round to digits significant digits, but keep the digits before the
+ * decimal point, see engineering_decimal().
+ */
+template< typename T >
+ENG_FORMAT_INLINE void to_engineering_decimal( T const value, int const digits, decimal & result )
+{
+    engineering_decimal<runtime_digits>( value, digits, result );
+}
+
+/*
+ * as to_engineering_decimal(), for a value in [1, 1024) that gets a binary prefix.
+ */
+ENG_FORMAT_INLINE void to_binary_decimal( double const value, int const digits, decimal & result )
+{
+    to_decimal( value, digits, result );
+
+    const int integral = result.exponent + 1;
+
+    if ( integral > digits )
+    {
+        decimal more;
+        to_decimal( value, integral, more );
+
+        if ( more.exponent == result.exponent )
+        {
+            result = more;
+        }
+        else while ( result.count < integral )
+        {
+            result.digits[ result.count++ ] = '0';
+        }
+    }
+}
+
+/*
+ * rounding made 1023.99 into 1024, which is 1 of the next binary degree.
+ */
+ENG_FORMAT_INLINE bool reaches_next_binary_degree( decimal const & dec )
+{
+    return 3 == dec.exponent && strncmp( dec.digits, "1024", 4 ) >= 0;
+}
+
+ENG_FORMAT_INLINE void set_to_one( decimal & dec, int const digits )
+{
+    dec.exponent  = 0;
+    dec.count     = digits;
+    dec.digits[0] = '1';
+
+    for ( int i = 1; i < digits; ++i )
+    {
+        dec.digits[i] = '0';
+    }
+}
+
+/*
+ * add one in the last place, 999 x 10^0 becomes 100 x 10^1.
+ */
+ENG_FORMAT_INLINE void round_up( decimal & dec )
+{
+    for ( int i = dec.count - 1; i >= 0; --i )
+    {
+        if ( '9' != dec.digits[i] )
+        {
+            ++dec.digits[i];
+            return;
+        }
+        dec.digits[i] = '0';
+    }
+
+    dec.digits[0] = '1';
+    ++dec.exponent;
+}
+
+/*
+ * round the exact digits d1..dn x 10^exponent to count significant digits,
+ * half to even, padding with zeros; the counterpart of to_decimal().
+ */
+ENG_FORMAT_INLINE void round_digits( char const * const digits, int const n, int const exponent, bool const negative, int const count, decimal & result )
+{
+    result.negative = negative;
+    result.exponent = exponent;
+    result.count    = count;
+
+    for ( int i = 0; i < count; ++i )
+    {
+        result.digits[i] = i < n ? digits[i] : '0';
+    }
+
+    if ( count < n )
+    {
+        bool up = digits[ count ] > '5';
+
+        if ( '5' == digits[ count ] )
+        {
+            up = ( digits[ count - 1 ] - '0' ) % 2;
+
+            for ( int i = count + 1; i < n && ! up; ++i )
+            {
+                up = '0' != digits[i];
+            }
+        }
+
+        if ( up )
+        {
+            round_up( result );
+        }
+    }
+}
+
+/*
+ * as to_engineering_decimal(), from exact digits.
+ */
+ENG_FORMAT_INLINE void to_engineering_decimal( char const * const digits, int const n, int const exponent, bool const negative, int const count, decimal & result )
 {
-    return is_zero( value ) ? 0 : lrint( floor( log10( fabs( value ) ) / 3) );
+    round_digits( digits, n, exponent, negative, count, result );
+
+    const int integral = integral_digits( result.exponent );
+
+    if ( integral > count )
+    {
+        decimal more;
+        round_digits( digits, n, exponent, negative, integral, more );
+
+        if ( more.exponent == result.exponent )
+        {
+            result = more;
+        }
+        else while ( result.count < integral )
+        {
+            result.digits[ result.count++ ] = '0';
+        }
+    }
 }
 
-int precision( double const scaled, int const digits )
+#if ENG_FORMAT_CPP11
+
+ENG_FORMAT_INLINE int bit_width( std::uint64_t const value )
 {
-    // MSVC6 requires -2 * DBL_EPSILON;
-    // g++ 4.8.1: ok with -1 * DBL_EPSILON
+#if defined( __GNUC__ )
+    return value ? 64 - __builtin_clzll( value ) : 0;
+#elif defined( _MSC_VER ) && defined( _M_X64 )
+    unsigned long index;
+    return _BitScanReverse64( &index, value ) ? static_cast<int>( index ) + 1 : 0;
+#else
+    int width = 0;
+    for ( std::uint64_t rest = value; rest; rest >>= 1 )
+    {
+        ++width;
+    }
+    return width;
+#endif
+}
+
+/*
+ * pow( 10, n ) for n = 0..19, all that fit in 64 bits.
+ */
+typedef const std::uint64_t uint64_powers_table[ 20 ];
 
-    return is_zero( scaled ) ? digits - 1 : digits - log10( fabs( scaled ) ) - 2 * DBL_EPSILON;
+ENG_FORMAT_INLINE uint64_powers_table & powers_of_ten()
+{
+    static uint64_powers_table table =
+    {
+        1ull, 10ull, 100ull, 1000ull, 10000ull, 100000ull, 1000000ull, 10000000ull,
+        100000000ull, 1000000000ull, 10000000000ull, 100000000000ull, 1000000000000ull,
+        10000000000000ull, 100000000000000ull, 1000000000000000ull, 10000000000000000ull,
+        100000000000000000ull, 1000000000000000000ull, 10000000000000000000ull,
+    };
+    return table;
 }
 
-std::string prefix_or_exponent( bool const exponential, int const degree, std::string separator )
+/*
+ * number of decimal digits, 1..20: log10( 2 ) ~ 1233 / 4096 gives the count
+ * from the bit width, or one less; the table settles which.
+ */
+ENG_FORMAT_INLINE int decimal_digit_count( std::uint64_t const value )
 {
-    return std::string( exponential || 0 == degree ? "" : separator ) + prefixes[ exponential ][ sign(degree) > 0 ][ abs( degree ) ];
+    const int guess = ( bit_width( value ) * 1233 ) >> 12;
+    return value ? guess + ( value >= powers_of_ten()[ guess ] ) : 1;
 }
 
-std::string exponent( int const degree )
+/*
+ * all decimal digits of an integer, most significant first, three at a
+ * time by division by 1000; returns the number of digits.
+ */
+ENG_FORMAT_INLINE int integer_digits( std::uint64_t value, char * const digits )
 {
-    std::ostringstream os;
-    os << "e" << 3 * degree;
-    return os.str();
+    const int count = decimal_digit_count( value );
+    char * pos = digits + count;
+
+    for ( ; value >= 1000; value /= 1000 )
+    {
+        const unsigned group = static_cast<unsigned>( value % 1000 );
+        *--pos = static_cast<char>( '0' + group % 10 );
+        *--pos = static_cast<char>( '0' + group / 10 % 10 );
+        *--pos = static_cast<char>( '0' + group / 100 );
+    }
+    do
+    {
+        *--pos = static_cast<char>( '0' + value % 10 );
+    }
+    while ( value /= 10 );
+
+    return count;
 }
 
-char const * first_non_space( char const * text )
+#endif // ENG_FORMAT_CPP11
+
+ENG_FORMAT_INLINE char const * first_non_space( char const * text )
 {
     while ( *text && isspace( *text ) )
     {
@@ -150,22 +541,22 @@ char const * first_non_space( char const * text )
     return text;
 }
 
-bool starts_with( std::string const text, std::string const start )
+ENG_FORMAT_INLINE bool starts_with( char const * text, char const * start )
 {
-    return 0 == text.find( start );
+    return 0 == strncmp( text, start, strlen( start ) );
 }
 
 /*
  * "k" => 3
  */
-int prefix_to_exponent( std::string const pfx )
+ENG_FORMAT_INLINE int prefix_to_exponent( char const * pfx )
 {
     for ( int i = 0; i < 2; ++i )
     {
-        // skip prefixes[0][i][0], it matches everything
+        // skip degree 0, its prefix matches everything
         for( int k = 1; k < prefix_count; ++k )
         {
-            if ( starts_with( pfx, prefixes[0][i][k] ) )
+            if ( starts_with( pfx, si_prefix( i ? k : -k ) ) )
             {
                 return ( i ? 1 : -1 ) * k * 3;
             }
@@ -174,80 +565,2282 @@ int prefix_to_exponent( std::string const pfx )
     return 0;
 }
 
-} // anonymous namespace
+/*
+ * degree of an IEC binary prefix, "Ki" is 1; 0 for none. Checked before the
+ * SI prefixes, so that "Mi" is not taken for "M".
+ */
+ENG_FORMAT_INLINE int binary_prefix_to_degree( char const * const pfx )
+{
+    if ( '\0' == pfx[0] || 'i' != pfx[1] )
+    {
+        return 0;
+    }
 
-/**
- * convert real number to prefixed or exponential notation, optionally followed by a unit.
+    for ( int k = 1; k < binary_prefix_count; ++k )
+    {
+        if ( pfx[0] == binary_prefixes()[k][0] )
+        {
+            return k;
+        }
+    }
+    return 0;
+}
+
+/*
+ * the exact digits of a number in text, such as "-0.0470e3".
  */
-std::string
-to_engineering_string( double const value, int const digits, bool exponential, std::string const unit /*= ""*/, std::string separator /*= " "*/ )
+struct exact_number
 {
-    if      ( is_nan( value ) ) return "NaN";
-    else if ( is_inf( value ) ) return "INFINITE";
+    bool negative;
+    int  exponent;                          // of the first digit
+    int  count;                             // 0 for zero
+    char digits[ eng_max_digits + 2 ];      // without leading zeros
+};
 
-    const int degree = degree_of( value );
+/*
+ * read the digits of a number, keeping the first eng_max_digits + 1 and
+ * a 1 for any that follow and are not 0, which is all that rounding to at
+ * most eng_max_digits needs. Returns the end of the number, text if there
+ * is none.
+ */
+ENG_FORMAT_INLINE char const * read_exact( char const * const text, exact_number & result )
+{
+    char const * pos = first_non_space( text );
 
-    std::string factor;
+    result.negative = '-' == *pos;
+    result.exponent = -1;
+    result.count    = 0;
 
-    if ( abs( degree ) < prefix_count )
+    if ( '-' == *pos || '+' == *pos )
     {
-        factor = prefix_or_exponent( exponential, degree, separator );
+        ++pos;
     }
-    else
+
+    const int room = ENG_FORMAT_DIMENSION_OF( result.digits ) - 1;
+    bool any = false, point = false, sticky = false;
+
+    for ( ; isdigit( *pos ) || ( '.' == *pos && !point ); ++pos )
+    {
+        if ( '.' == *pos )
+        {
+            point = true;
+            continue;
+        }
+
+        any = true;
+
+        if      ( result.count == 0 && '0' == *pos ) { if ( point ) --result.exponent; }
+        else if ( result.count < room )              { result.digits[ result.count++ ] = *pos; if ( !point ) ++result.exponent; }
+        else                                         { sticky = sticky || '0' != *pos;         if ( !point ) ++result.exponent; }
+    }
+
+    if ( !any )
     {
-        exponential = true;
-        factor = exponent( degree );
+        return text;
     }
 
-    std::ostringstream os;
+    if ( sticky )
+    {
+        result.digits[ result.count++ ] = '1';
+    }
 
-    const double scaled = value * pow( 1000.0, -degree );
+    // an exponent, but not a prefix E, exa, as in "1 E" or "1E":
+    if ( ( 'e' == *pos || 'E' == *pos ) && ( isdigit( pos[1] ) || ( ( '-' == pos[1] || '+' == pos[1] ) && isdigit( pos[2] ) ) ) )
+    {
+        char * end;
+        const long exponent = strtol( pos + 1, &end, 10 );
 
-    const std::string space = ( 0 == degree || exponential ) && unit.length() ? separator : "";
+        result.exponent += static_cast<int>( (std::max)( (std::min)( exponent, 100000L ), -100000L ) );
+        pos = end;
+    }
 
-    os << std::fixed << std::setprecision( precision( scaled, digits ) ) << scaled << factor << space << unit;
+    if ( 0 == result.count )
+    {
+        result.exponent = 0;
+    }
 
-    return os.str();
+    return pos;
 }
 
-/**
- * convert the output of to_engineering_string() into a double.
- *
- * The engineering presentation should not contain a unit, as the first letter
- * is interpreted as an SI prefix, e.g. "1 T" is 1e12, not 1 (Tesla).
- *
- * "1.23 M"   => 1.23e+6
- * "1.23 kPa" => 1.23e+3  (ok, but not recommended)
- * "1.23 Pa"  => 1.23e+12 (not what's intended!)
+/*
+ * what text in prefixed or exponential notation holds.
  */
-double from_engineering_string( std::string const text )
-{
-    char * tail;
-    const double magnitude = strtod( text.c_str(), &tail );
-
-    return magnitude * pow( 10.0, prefix_to_exponent( first_non_space( tail ) ) );
-}
+enum text_kind { text_none, text_exact, text_binary, text_nan, text_infinite };
 
-/**
- * step a value by the smallest possible increment.
+/*
+ * read text in prefixed or exponential notation: the exact digits of its
+ * number with the prefix applied, where the unit alone, "1 m" with unit "m",
+ * is no prefix. A binary prefix is not applied: text_binary.
  */
-std::string step_engineering_string( std::string const text, int digits, bool const exponential, bool const positive )
+ENG_FORMAT_INLINE text_kind read_engineering( char const * const text, char const * const unit, exact_number & number )
 {
-    const double value = from_engineering_string( text );
+    char const * const tail = read_exact( text, number );
 
-    if ( digits < 3 )
+    if ( tail == text )
+    {
+        char const * word = first_non_space( text );
+        word += '-' == *word || '+' == *word;
+
+        return starts_with( word, "NaN" ) ? text_nan : starts_with( word, "INFINITE" ) ? text_infinite : text_none;
+    }
+
+    char const * const prefix = first_non_space( tail );
+
+    if ( binary_prefix_to_degree( prefix ) )
+    {
+        return text_binary;
+    }
+
+    if ( number.count && !( *unit && 0 == strcmp( prefix, unit ) ) )
+    {
+        number.exponent += prefix_to_exponent( prefix );
+    }
+
+    return text_exact;
+}
+
+/*
+ * the first byte of a sort key: text without a number first, NaN last.
+ */
+enum sort_class
+{
+    sort_none           = 0x00,
+    sort_minus_infinity = 0x10,
+    sort_negative       = 0x20,
+    sort_zero           = 0x30,
+    sort_positive       = 0x40,
+    sort_plus_infinity  = 0x50,
+    sort_nan            = 0x60
+};
+
+/*
+ * the exact digits of a decimal, without the zeros of zero.
+ */
+ENG_FORMAT_INLINE void to_exact( decimal const & dec, exact_number & number )
+{
+    number.negative = dec.negative;
+    number.exponent = dec.exponent;
+    number.count    = '0' == dec.digits[0] ? 0 : dec.count;
+
+    memcpy( number.digits, dec.digits, dec.count );
+}
+
+/*
+ * largest magnitude of the finite values, portable variant.
+ */
+ENG_FORMAT_INLINE double max_magnitude_generic( double const * const values, std::size_t const count )
+{
+    double result = 0;
+
+    for ( std::size_t i = 0; i < count; ++i )
+    {
+        const double magnitude = fabs( values[i] );
+
+        // false for NaN and infinity:
+        if ( magnitude <= DBL_MAX && magnitude > result )
+        {
+            result = magnitude;
+        }
+    }
+    return result;
+}
+
+#if ENG_FORMAT_DISPATCH
+
+/*
+ * the x86 variants clear the sign bit, zero the lanes that are not finite
+ * and keep the lane-wise maximum; the tail goes to the portable variant.
+ */
+__attribute__(( target( "sse2" ) ))
+ENG_FORMAT_INLINE double max_magnitude_sse2( double const * const values, std::size_t const count )
+{
+    const __m128d sign    = _mm_set1_pd( -0.0 );
+    const __m128d largest = _mm_set1_pd( DBL_MAX );
+
+    __m128d result = _mm_setzero_pd();
+    std::size_t i = 0;
+
+    for ( ; i + 2 <= count; i += 2 )
+    {
+        const __m128d magnitude = _mm_andnot_pd( sign, _mm_loadu_pd( values + i ) );
+        result = _mm_max_pd( result, _mm_and_pd( magnitude, _mm_cmple_pd( magnitude, largest ) ) );
+    }
+
+    double lanes[2];
+    _mm_storeu_pd( lanes, result );
+
+    const double tail = max_magnitude_generic( values + i, count - i );
+    return (std::max)( (std::max)( lanes[0], lanes[1] ), tail );
+}
+
+__attribute__(( target( "avx2" ) ))
+ENG_FORMAT_INLINE double max_magnitude_avx2( double const * const values, std::size_t const count )
+{
+    const __m256d sign    = _mm256_set1_pd( -0.0 );
+    const __m256d largest = _mm256_set1_pd( DBL_MAX );
+
+    __m256d result = _mm256_setzero_pd();
+    std::size_t i = 0;
+
+    for ( ; i + 4 <= count; i += 4 )
+    {
+        const __m256d magnitude = _mm256_andnot_pd( sign, _mm256_loadu_pd( values + i ) );
+        result = _mm256_max_pd( result, _mm256_and_pd( magnitude, _mm256_cmp_pd( magnitude, largest, _CMP_LE_OQ ) ) );
+    }
+
+    double lanes[4];
+    _mm256_storeu_pd( lanes, result );
+
+    const double tail = max_magnitude_generic( values + i, count - i );
+    return (std::max)( (std::max)( (std::max)( lanes[0], lanes[1] ), (std::max)( lanes[2], lanes[3] ) ), tail );
+}
+
+__attribute__(( target( "avx512f" ) ))
+ENG_FORMAT_INLINE double max_magnitude_avx512( double const * const values, std::size_t const count )
+{
+    const __m512d largest = _mm512_set1_pd( DBL_MAX );
+
+    __m512d result = _mm512_setzero_pd();
+    std::size_t i = 0;
+
+    for ( ; i + 8 <= count; i += 8 )
+    {
+        const __m512d magnitude = _mm512_abs_pd( _mm512_loadu_pd( values + i ) );
+        result = _mm512_mask_max_pd( result, _mm512_cmp_pd_mask( magnitude, largest, _CMP_LE_OQ ), result, magnitude );
+    }
+
+    double lanes[8];
+    _mm512_storeu_pd( lanes, result );
+
+    return (std::max)( *std::max_element( lanes, lanes + 8 ), max_magnitude_generic( values + i, count - i ) );
+}
+
+#endif // ENG_FORMAT_DISPATCH
+
+/*
+ * the vector kernels of one instruction set.
+ */
+struct vector_kernels
+{
+    char const * isa;
+    bool supported;
+    double (*max_magnitude)( double const * values, std::size_t count );
+};
+
+/*
+ * the widest supported variant, or the one named by environment variable
+ * ENG_FORMAT_ISA if the CPU supports it; chosen once.
+ */
+ENG_FORMAT_INLINE vector_kernels choose_kernels()
+{
+#if ENG_FORMAT_DISPATCH
+    __builtin_cpu_init();
+
+    const vector_kernels candidates[] =
+    {
+        { "avx512" , 0 != __builtin_cpu_supports( "avx512f" ), max_magnitude_avx512  },
+        { "avx2"   , 0 != __builtin_cpu_supports( "avx2"    ), max_magnitude_avx2    },
+        { "sse2"   , 0 != __builtin_cpu_supports( "sse2"    ), max_magnitude_sse2    },
+        { "generic", true                                    , max_magnitude_generic },
+    };
+#else
+    const vector_kernels candidates[] =
+    {
+        { "generic", true, max_magnitude_generic },
+    };
+#endif
+    const int count = ENG_FORMAT_DIMENSION_OF( candidates );
+
+    if ( char const * const requested = getenv( "ENG_FORMAT_ISA" ) )
+    {
+        for ( int i = 0; i < count; ++i )
+        {
+            if ( candidates[i].supported && 0 == strcmp( requested, candidates[i].isa ) )
+            {
+                return candidates[i];
+            }
+        }
+    }
+
+    int best = 0;
+    while ( ! candidates[ best ].supported )
+    {
+        ++best;
+    }
+    return candidates[ best ];
+}
+
+ENG_FORMAT_INLINE vector_kernels const & kernels()
+{
+    static const vector_kernels chosen = choose_kernels();
+    return chosen;
+}
+
+#if ENG_FORMAT_STATS
+
+enum stat_counter
+{
+    stat_prefixed, stat_exponential, stat_binary, stat_exponent_fallback, stat_nan, stat_infinite,
+    stat_parses, stat_parse_failures, stat_steps, stat_counter_count
+};
+
+/*
+ * the counts of one thread; only that thread writes them, so an increment
+ * is a relaxed load and store, not a locked read-modify-write.
+ */
+struct stat_block
+{
+    std::atomic<unsigned long long> counts[ stat_counter_count ];
+    stat_block * next;
+};
+
+/*
+ * the blocks of the running threads, and the sum of the ended ones.
+ */
+struct stat_registry
+{
+    std::mutex mutex;
+    stat_block * first;
+    unsigned long long ended[ stat_counter_count ];
+};
+
+ENG_FORMAT_INLINE stat_registry & registry()
+{
+    static stat_registry instance;
+    return instance;
+}
+
+/*
+ * registers the block of a thread at its first count, and adds its counts
+ * to those of the ended threads when it ends.
+ */
+class thread_stats
+{
+public:
+    thread_stats()
+    {
+        for ( int i = 0; i < stat_counter_count; ++i )
+        {
+            block.counts[i].store( 0, std::memory_order_relaxed );
+        }
+
+        stat_registry & reg = registry();
+        std::lock_guard<std::mutex> lock( reg.mutex );
+
+        block.next = reg.first;
+        reg.first  = &block;
+    }
+
+    ~thread_stats()
+    {
+        stat_registry & reg = registry();
+        std::lock_guard<std::mutex> lock( reg.mutex );
+
+        for ( int i = 0; i < stat_counter_count; ++i )
+        {
+            reg.ended[i] += block.counts[i].load( std::memory_order_relaxed );
+        }
+
+        stat_block ** link = &reg.first;
+        while ( *link != &block )
+        {
+            link = &(*link)->next;
+        }
+        *link = block.next;
+    }
+
+    stat_block block;
+};
+
+ENG_FORMAT_INLINE void count( stat_counter const counter )
+{
+    static thread_local thread_stats stats;
+
+    std::atomic<unsigned long long> & n = stats.block.counts[ counter ];
+    n.store( n.load( std::memory_order_relaxed ) + 1, std::memory_order_relaxed );
+}
+
+#endif // ENG_FORMAT_STATS
+
+/*
+ * write the prefix or the exponent of a degree, and the unit, counting
+ * the fallback to exponential notation beyond the prefixes.
+ */
+ENG_FORMAT_INLINE void put_suffix( writer & out, int const degree, bool const exponential, char const * const unit, char const * const separator )
+{
+    if ( ! exponential && abs( degree ) >= prefix_count )
+    {
+        ENG_FORMAT_COUNT( stat_exponent_fallback );
+    }
+
+    write_suffix( out, degree, exponential, unit, separator );
+}
+
+/*
+ * write a finite value in prefixed or exponential notation.
+ */
+ENG_FORMAT_INLINE void put_engineering( writer & out, decimal const & dec, bool const exponential, char const * const unit, char const * const separator )
+{
+    write_digits( out, dec );
+    put_suffix( out, degree_of( dec.exponent ), exponential, unit, separator );
+}
+
+/*
+ * text in prefixed or exponential notation, optionally with the unit, to
+ * the specified number of digits, exactly, from the decimal digits. A
+ * binary prefix goes through a double.
+ */
+ENG_FORMAT_INLINE void transcode( writer & out, char const * const text, int const digits, bool const exponential, char const * const unit, char const * const separator )
+{
+    ENG_FORMAT_COUNT( stat_parses );
+
+    if ( exponential ) { ENG_FORMAT_COUNT( stat_exponential ); }
+    else               { ENG_FORMAT_COUNT( stat_prefixed    ); }
+
+    exact_number number;
+    decimal dec;
+
+    switch ( read_engineering( text, unit, number ) )
+    {
+        case text_none:     ENG_FORMAT_COUNT( stat_parse_failures ); return;
+        case text_nan:      ENG_FORMAT_COUNT( stat_nan      ); out.put( "NaN"      ); return;
+        case text_infinite: ENG_FORMAT_COUNT( stat_infinite ); out.put( "INFINITE" ); return;
+        case text_binary:   to_engineering_decimal( from_engineering_chars( text ), clamp_digits( digits ), dec ); break;
+        case text_exact:    to_engineering_decimal( number.digits, number.count, number.exponent, number.negative, clamp_digits( digits ), dec ); break;
+    }
+
+    put_engineering( out, dec, exponential, unit, separator );
+}
+
+/*
+ * no digits, for zero, or a single 1 at 10^place.
+ */
+ENG_FORMAT_INLINE void set_to_place( decimal & result, bool const negative, int const place, bool const one )
+{
+    result.negative  = negative;
+    result.exponent  = one ? place : place - 1;
+    result.count     = one ? 1 : 0;
+    result.digits[0] = '1';
+}
+
+/*
+ * value rounded to a multiple of 10^place, half to even: the digits down to
+ * that place, none if it rounds to zero. log10() gives the exponent of the
+ * first digit, or one off near a power of ten; the exponent of the result
+ * shows whether it was right, otherwise 17 digits settle it.
+ */
+ENG_FORMAT_INLINE void round_to_place( double const value, int const place, decimal & result )
+{
+    const bool negative = is_negative( value );
+    const int  guess    = is_zero( value ) ? place - 3 : static_cast<int>( floor( log10( fabs( value ) ) ) );
+
+    // far below the place:
+    if ( guess + 2 < place )
+    {
+        set_to_place( result, negative, place, false );
+        return;
+    }
+
+    if ( guess - place + 1 >= 1 && guess - place + 1 <= eng_max_digits )
+    {
+        to_decimal( value, guess - place + 1, result );
+
+        if ( result.exponent == guess )
+        {
+            return;
+        }
+    }
+    else if ( guess - place + 1 == 0 )
+    {
+        // just below the place, the first digit tells, unless it is a 5:
+        to_decimal( value, 1, result );
+
+        if ( result.exponent == guess && '5' != result.digits[0] )
+        {
+            set_to_place( result, negative, place, result.digits[0] > '5' );
+            return;
+        }
+    }
+
+    // 17 digits never round up to the next power of ten:
+    decimal probe;
+    to_decimal( value, 17, probe );
+
+    const int count = probe.exponent - place + 1;
+
+    if ( count >= 1 )
+    {
+        to_decimal( value, (std::min)( count, +eng_max_digits ), result );
+
+        // 9.96 to 10.0 needs a zero in the last place:
+        if ( result.exponent > probe.exponent && result.count < eng_max_digits )
+        {
+            result.digits[ result.count++ ] = '0';
+        }
+        return;
+    }
+
+    bool up = false;
+
+    if ( 0 == count )
+    {
+        // one if above half of the place; a tie goes to zero, even:
+        to_decimal( value, eng_max_digits, probe );
+
+        up = probe.digits[0] > '5';
+        for ( int i = 1; i < probe.count && '5' == probe.digits[0] && ! up; ++i )
+        {
+            up = '0' != probe.digits[i];
+        }
+    }
+
+    set_to_place( result, negative, place, up );
+}
+
+/*
+ * write rounded digits in fixed notation, with the decimal point before
+ * the digit of 10^( 3 x degree - 1 ) and down to 10^place.
+ */
+ENG_FORMAT_INLINE void put_fixed( writer & out, decimal const & dec, int const degree, int const place )
+{
+    if ( dec.negative )
+    {
+        out.put( '-' );
+    }
+
+    for ( int k = (std::max)( dec.exponent, 3 * degree ); k >= place; --k )
+    {
+        if ( k == 3 * degree - 1 )
+        {
+            out.put( '.' );
+        }
+
+        const int i = dec.exponent - k;
+        out.put( 0 <= i && i < dec.count ? dec.digits[i] : '0' );
+    }
+}
+
+/*
+ * 1000^degree, from the table for the degrees that have a prefix.
+ */
+ENG_FORMAT_INLINE double power_of_thousand( int const degree )
+{
+    return abs( degree ) < prefix_count ? powers_of_thousand()[ prefix_count - 1 + degree ] : pow( 1000.0, degree );
+}
+
+/*
+ * 10^n for n = 0..22, all that are exact in a double.
+ */
+typedef const double exact_powers_table[ 23 ];
+
+ENG_FORMAT_INLINE exact_powers_table & exact_powers_of_ten()
+{
+    static exact_powers_table table =
+    {
+        1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22,
+    };
+    return table;
+}
+
+ENG_FORMAT_INLINE double power_of_ten( int const n )
+{
+    return n < ENG_FORMAT_DIMENSION_OF( exact_powers_of_ten() ) ? exact_powers_of_ten()[ n ] : pow( 10.0, n );
+}
+
+/*
+ * n x 10^exponent, correctly rounded while 10^exponent is exact, up to 10^22.
+ */
+ENG_FORMAT_INLINE double scaled( double const n, int const exponent )
+{
+    return exponent >= 0 ? n * power_of_ten( exponent ) : n / power_of_ten( -exponent );
+}
+
+/*
+ * write labels right-aligned in width characters; a label that does not fit
+ * is filled with '#'.
+ */
+ENG_FORMAT_INLINE void put_label( writer & out, char const * const label, std::size_t const length, int const width )
+{
+    for ( int i = static_cast<int>( length ); i < width; ++i )
+    {
+        out.put( ' ' );
+    }
+
+    if ( length > static_cast<std::size_t>( width ) )
+    {
+        for ( int i = 0; i < width; ++i )
+        {
+            out.put( '#' );
+        }
+        return;
+    }
+    out.put( label );
+}
+
+/*
+ * write a value in [1, 1024) with the binary prefix of the given degree.
+ */
+ENG_FORMAT_INLINE void put_binary( writer & out, decimal const & dec, int const degree, char const * const unit, char const * const separator )
+{
+    if ( dec.negative )
+    {
+        out.put( '-' );
+    }
+
+    for ( int i = 0; i < dec.count; ++i )
+    {
+        if ( i == dec.exponent + 1 )
+        {
+            out.put( '.' );
+        }
+        out.put( dec.digits[i] );
+    }
+
+    if ( 0 != degree || *unit )
+    {
+        out.put( separator );
+    }
+
+    out.put( binary_prefixes()[ degree ] );
+    out.put( unit );
+}
+
+/*
+ * a double, float or long double in prefixed or exponential notation.
+ */
+template< typename T >
+ENG_FORMAT_INLINE std::size_t format_real( char * const buffer, std::size_t const capacity, T const value, int const digits, bool const exponential, char const * const unit, char const * const separator )
+{
+    ENG_FORMAT_PROBE3( to_engineering_entry, static_cast<double>( value ), digits, exponential );
+
+    if ( exponential ) { ENG_FORMAT_COUNT( stat_exponential ); }
+    else               { ENG_FORMAT_COUNT( stat_prefixed    ); }
+
+    writer out( buffer, capacity );
+
+    if      ( is_nan( value ) ) { ENG_FORMAT_COUNT( stat_nan      ); out.put( "NaN"      ); }
+    else if ( is_inf( value ) ) { ENG_FORMAT_COUNT( stat_infinite ); out.put( "INFINITE" ); }
+    else
+    {
+        decimal dec;
+        to_engineering_decimal( value, clamp_digits( digits ), dec );
+        put_engineering( out, dec, exponential, unit, separator );
+    }
+
+    const std::size_t length = out.finish();
+
+    ENG_FORMAT_PROBE1( to_engineering_return, length );
+
+    return length;
+}
+
+#if ENG_FORMAT_CPP11
+
+/*
+ * an integer in IEC binary notation, exactly: the degree comes from the
+ * highest bit; the integral part and the fraction from shifts, so that the
+ * fraction times 10 stays below 2^64. Rounds half to even.
+ */
+ENG_FORMAT_INLINE std::size_t binary_to_chars( char * const buffer, std::size_t const capacity, bool const negative, std::uint64_t const magnitude, int const digits, char const * const unit, char const * const separator )
+{
+    ENG_FORMAT_COUNT( stat_binary );
+
+    const int count = clamp_digits( digits );
+    const int shift = 10 * ( magnitude ? ( bit_width( magnitude ) - 1 ) / 10 : 0 );
+    const std::uint64_t mask = ( std::uint64_t( 1 ) << shift ) - 1;
+
+    decimal dec;
+    dec.negative = negative;
+    dec.count    = 0;
+
+    // integral part, 1 to 4 digits:
+    char integral[ 4 ];
+    int length = 0;
+    for ( std::uint64_t rest = magnitude >> shift; ; rest /= 10 )
+    {
+        integral[ length++ ] = static_cast<char>( '0' + rest % 10 );
+        if ( rest < 10 ) break;
+    }
+    while ( length )
+    {
+        dec.digits[ dec.count++ ] = integral[ --length ];
+    }
+    dec.exponent = dec.count - 1;
+
+    std::uint64_t fraction = magnitude & mask;
+    while ( dec.count < count )
+    {
+        fraction *= 10;
+        dec.digits[ dec.count++ ] = static_cast<char>( '0' + ( fraction >> shift ) );
+        fraction &= mask;
+    }
+
+    if ( shift > 0 )
+    {
+        const std::uint64_t half = std::uint64_t( 1 ) << ( shift - 1 );
+
+        if ( fraction > half || ( fraction == half && ( dec.digits[ dec.count - 1 ] - '0' ) % 2 ) )
+        {
+            round_up( dec );
+
+            if ( dec.count < dec.exponent + 1 )
+            {
+                dec.digits[ dec.count++ ] = '0';
+            }
+        }
+    }
+
+    int degree = shift / 10;
+
+    if ( reaches_next_binary_degree( dec ) )
+    {
+        ++degree;
+        set_to_one( dec, count );
+    }
+
+    writer out( buffer, capacity );
+    put_binary( out, dec, degree, unit, separator );
+    return out.finish();
+}
+
+/*
+ * a scaled integer, magnitude x 10^exponent, in prefixed or exponential
+ * notation, exactly: the digits come from integer division, the rounding
+ * from the digits; there is no conversion to double.
+ */
+ENG_FORMAT_INLINE std::size_t integer_to_chars( char * const buffer, std::size_t const capacity, bool const negative, std::uint64_t const magnitude, int const exponent, int const digits, bool const exponential, char const * const unit, char const * const separator )
+{
+    if ( exponential ) { ENG_FORMAT_COUNT( stat_exponential ); }
+    else               { ENG_FORMAT_COUNT( stat_prefixed    ); }
+
+    char all[ 20 ];
+    const int n = integer_digits( magnitude, all );
+
+    decimal dec;
+    to_engineering_decimal( all, n, magnitude ? exponent + n - 1 : 0, negative, clamp_digits( digits ), dec );
+
+    writer out( buffer, capacity );
+    put_engineering( out, dec, exponential, unit, separator );
+    return out.finish();
+}
+
+ENG_FORMAT_INLINE std::size_t real_to_chars( char * const buffer, std::size_t const capacity, float const value, int const digits, bool const exponential, char const * const unit, char const * const separator )
+{
+    return format_real( buffer, capacity, value, digits, exponential, unit, separator );
+}
+
+ENG_FORMAT_INLINE std::size_t real_to_chars( char * const buffer, std::size_t const capacity, long double const value, int const digits, bool const exponential, char const * const unit, char const * const separator )
+{
+    return format_real( buffer, capacity, value, digits, exponential, unit, separator );
+}
+
+/*
+ * characters that make appending an exponent to a number unsafe: "1e3", "0x1".
+ */
+ENG_FORMAT_INLINE bool is_exponent_or_hex( char const chr )
+{
+    return 'e' == chr || 'E' == chr || 'x' == chr || 'X' == chr;
+}
+
+ENG_FORMAT_INLINE float to_real( char const * const text, char ** const tail, float )
+{
+    return strtof( text, tail );
+}
+
+ENG_FORMAT_INLINE long double to_real( char const * const text, char ** const tail, long double )
+{
+    return strtold( text, tail );
+}
+
+/*
+ * parse to float or long double. The number with the exponent of the SI
+ * prefix appended is parsed again, so that the result is rounded once.
+ */
+template< typename T >
+ENG_FORMAT_INLINE T parse_real( char const * const text )
+{
+    ENG_FORMAT_PROBE1( from_engineering_entry, text );
+    ENG_FORMAT_COUNT( stat_parses );
+
+    char * tail;
+    T result = to_real( text, &tail, T() );
+
+    if ( tail == text )
+    {
+        ENG_FORMAT_COUNT( stat_parse_failures );
+    }
+
+    char const * const prefix = first_non_space( tail );
+    const int binary_degree   = binary_prefix_to_degree( prefix );
+    const int exponent        = binary_degree ? 0 : prefix_to_exponent( prefix );
+
+    const std::size_t length  = static_cast<std::size_t>( tail - text );
+    char scaled[ 64 ];
+
+    if ( binary_degree )
+    {
+        result = ldexp( result, 10 * binary_degree );
+    }
+    else if ( exponent && length + 8 < sizeof scaled && text + length == std::find_if( text, text + length, is_exponent_or_hex ) )
+    {
+        memcpy( scaled, text, length );
+
+        writer out( scaled + length, sizeof scaled - length );
+        out.put( 'e' );
+        out.put( exponent );
+        out.finish();
+
+        result = to_real( scaled, &tail, T() );
+    }
+    else if ( exponent )
+    {
+        result *= pow( T( 10 ), exponent );
+    }
+
+    ENG_FORMAT_PROBE1( from_engineering_return, static_cast<double>( result ) );
+
+    return result;
+}
+
+ENG_FORMAT_INLINE float real_from_chars( char const * const text, float )
+{
+    return parse_real<float>( text );
+}
+
+ENG_FORMAT_INLINE long double real_from_chars( char const * const text, long double )
+{
+    return parse_real<long double>( text );
+}
+
+/*
+ * the digits of a magnitude rounded to count digits as an integer, and the
+ * exponent of the first digit, from scaling by a power of ten: the scaled
+ * value is within a few units in the last place, which is far less than
+ * 1e-3 while it stays below 10^12. Fails near a tie, and for magnitudes far
+ * from 1, where the power of ten does not fit.
+ */
+ENG_FORMAT_INLINE bool scaled_digits( double const magnitude, int const count, std::uint64_t & digits, int & exponent )
+{
+    if ( !( 1e-280 < magnitude && magnitude < 1e280 ) || count > 12 )
+    {
+        return false;
+    }
+
+    for ( int tries = 0; tries < 2; ++tries )
+    {
+        const double scaled_value = scaled( magnitude, count - 1 - exponent );
+        const double whole = floor( scaled_value );
+
+        if ( fabs( scaled_value - whole - 0.5 ) < 1e-3 )
+        {
+            return false;
+        }
+
+        digits = static_cast<std::uint64_t>( whole ) + ( scaled_value - whole > 0.5 );
+
+        // the estimate of the exponent may be one off:
+        if      ( digits <  powers_of_ten()[ count - 1 ] ) { --exponent; }
+        else if ( digits <= powers_of_ten()[ count     ] ) { break;      }
+        else                                             { ++exponent; }
+    }
+
+    if ( !( powers_of_ten()[ count - 1 ] <= digits && digits <= powers_of_ten()[ count ] ) )
+    {
+        return false;
+    }
+
+    // 9.996 to 3 digits carries to 10.0:
+    if ( digits == powers_of_ten()[ count ] )
+    {
+        digits = powers_of_ten()[ count - 1 ];
+        ++exponent;
+    }
+
+    return true;
+}
+
+/*
+ * a sort key and the position of its text, ordered by key, then position,
+ * so that sorting is stable.
+ */
+struct keyed_text
+{
+    eng_sort_key_t key;
+    std::size_t index;
+
+    bool operator<( keyed_text const & other ) const
+    {
+        const int order = memcmp( key.bytes, other.key.bytes, sizeof key.bytes );
+        return order < 0 || ( 0 == order && index < other.index );
+    }
+};
+
+ENG_FORMAT_INLINE char const * text_of( char const * const text ) { return text; }
+ENG_FORMAT_INLINE char const * text_of( std::string const & text ) { return text.c_str(); }
+
+/*
+ * sort texts by their keys: each thread makes the keys of a chunk and sorts
+ * it; chunks are then merged pairwise, the pairs of a level in parallel;
+ * finally the texts are moved into the order of the keys.
+ */
+template< typename Text >
+ENG_FORMAT_INLINE void sort_texts( Text * const texts, std::size_t const count, char const * const unit, unsigned const threads )
+{
+    const std::size_t workers = threads ? threads : (std::max)( std::thread::hardware_concurrency(), 1u );
+    const std::size_t chunks  = (std::max)( (std::min)( workers, count / 16384 ), std::size_t( 1 ) );
+
+    std::vector<keyed_text> keys( count );
+
+    const auto bound = [=]( std::size_t const chunk ) { return count * chunk / chunks; };
+
+    const auto sort_chunk = [&]( std::size_t const chunk )
+    {
+        for ( std::size_t i = bound( chunk ); i < bound( chunk + 1 ); ++i )
+        {
+            keys[i].key   = eng_sort_key( text_of( texts[i] ), unit );
+            keys[i].index = i;
+        }
+        std::sort( keys.begin() + bound( chunk ), keys.begin() + bound( chunk + 1 ) );
+    };
+
+    std::vector<std::thread> pool;
+
+    for ( std::size_t chunk = 1; chunk < chunks; ++chunk )
+    {
+        pool.emplace_back( sort_chunk, chunk );
+    }
+    sort_chunk( 0 );
+
+    for ( std::size_t width = 1; width < chunks; width *= 2 )
+    {
+        for ( std::size_t i = 0; i < pool.size(); ++i )
+        {
+            pool[i].join();
+        }
+        pool.clear();
+
+        for ( std::size_t chunk = 0; chunk + width < chunks; chunk += 2 * width )
+        {
+            const std::size_t first = bound( chunk ), middle = bound( chunk + width ), last = bound( (std::min)( chunk + 2 * width, chunks ) );
+
+            pool.emplace_back( [&keys, first, middle, last]
+            {
+                std::inplace_merge( keys.begin() + first, keys.begin() + middle, keys.begin() + last );
+            } );
+        }
+    }
+
+    for ( std::size_t i = 0; i < pool.size(); ++i )
+    {
+        pool[i].join();
+    }
+
+    std::vector<Text> sorted;
+    sorted.reserve( count );
+
+    for ( std::size_t i = 0; i < count; ++i )
+    {
+        sorted.push_back( std::move( texts[ keys[i].index ] ) );
+    }
+    std::move( sorted.begin(), sorted.end(), texts );
+}
+
+/*
+ * the digits of a decimal as an integer: up to 19 digits fit.
+ */
+ENG_FORMAT_INLINE std::uint64_t integer_of( decimal const & dec )
+{
+    std::uint64_t result = 0;
+
+    for ( int i = 0; i < dec.count; ++i )
+    {
+        result = 10 * result + ( dec.digits[i] - '0' );
+    }
+    return result;
+}
+
+/*
+ * the digits of to_engineering_decimal() as an integer, and the exponent of
+ * the first digit: a magnitude rounded to count digits, or to its integral
+ * digits when there are more.
+ */
+ENG_FORMAT_INLINE bool scaled_engineering_digits( double const magnitude, int const count, std::uint64_t & digits, int & exponent, int & shown )
+{
+    // from the binary exponent, at most one too low:
+    int binary;
+    frexp( magnitude, &binary );
+
+    exponent = static_cast<int>( floor( ( binary - 1 ) * 0.30102999566398120 ) );
+    shown    = count;
+
+    if ( !scaled_digits( magnitude, count, digits, exponent ) )
+    {
+        return false;
+    }
+
+    const int integral = integral_digits( exponent );
+
+    if ( integral > count )
+    {
+        std::uint64_t more;
+        int more_exponent = exponent;
+
+        if ( !scaled_digits( magnitude, integral, more, more_exponent ) )
+        {
+            return false;
+        }
+
+        // 99.5 with 2 digits carries to 100, rounding it to 3 digits does not:
+        digits = more_exponent == exponent ? more : digits * powers_of_ten()[ integral - count ];
+        shown  = integral;
+    }
+
+    return true;
+}
+
+/*
+ * the digits of a magnitude in the degree of a display, rounded to place,
+ * from one scaling by a power of ten: the exponent of the first digit comes
+ * from the degree, the place from the exponent. Fails, for the conversion
+ * that settles it, near a tie, one off, beyond the magnitudes that the
+ * range of a degree has with hysteresis, and where rounding to count digits
+ * may carry into the next power of ten: 96 with 1 digit shows 100.
+ */
+ENG_FORMAT_INLINE bool display_digits( double const magnitude, int const count, int const degree, decimal & result, int & place )
+{
+    if ( !( 1e-280 < magnitude && magnitude < 1e280 ) || count > 12 )
+    {
+        return false;
+    }
+
+    const double relative = scaled( magnitude, -3 * degree );
+
+    if ( !( 0.1 <= relative && relative < 10000 ) )
+    {
+        return false;
+    }
+
+    // the exponent of the first digit and the place, relative to the degree:
+    int exponent = relative < 1 ? -1 : relative < 10 ? 0 : relative < 100 ? 1 : relative < 1000 ? 2 : 3;
+    int lowest   = (std::min)( exponent - count + 1, 0 );
+    int shown    = exponent - lowest + 1;
+
+    const double scaled_value = scaled( magnitude, -( 3 * degree + lowest ) );
+    const double whole = floor( scaled_value );
+
+    if ( fabs( scaled_value - whole - 0.5 ) < 1e-3 )
+    {
+        return false;
+    }
+
+    std::uint64_t digits = static_cast<std::uint64_t>( whole ) + ( scaled_value - whole > 0.5 );
+
+    if ( !( powers_of_ten()[ shown - 1 ] <= digits && digits <= powers_of_ten()[ shown ] ) )
+    {
+        return false;
+    }
+
+    // 99.96 to 3 digits carries to 100, in the place of the next exponent:
+    if ( digits == powers_of_ten()[ shown ] )
+    {
+        if ( (std::min)( ++exponent - count + 1, 0 ) > lowest )
+        {
+            ++lowest;
+            digits /= 10;
+        }
+        shown = exponent - lowest + 1;
+    }
+
+    if ( shown > count && digits >= ( powers_of_ten()[ count ] - 1 ) * powers_of_ten()[ shown - count ] )
+    {
+        return false;
+    }
+
+    result.exponent = 3 * degree + exponent;
+    result.count    = shown;
+
+    for ( int i = shown - 1; i >= 0; --i, digits /= 10 )
+    {
+        result.digits[i] = static_cast<char>( '0' + digits % 10 );
+    }
+
+    place = 3 * degree + lowest;
+
+    return true;
+}
+
+/*
+ * a value to render and the id of its format.
+ */
+struct log_record
+{
+    double value;
+    int format;
+};
+
+/*
+ * the single-producer, single-consumer ring of one thread: the thread owns
+ * head and its copy of tail, the background thread owns tail. The padding
+ * keeps them on separate cache lines.
+ */
+struct log_ring
+{
+    explicit log_ring( std::size_t const capacity )
+    : records( capacity ), mask( capacity - 1 ), head( 0 ), cached_tail( 0 ), dropped( 0 ), tail( 0 ) {}
+
+    std::vector<log_record> records;
+    const std::size_t mask;
+    char before_head[ 64 ];
+    std::atomic<std::size_t> head;
+    std::size_t cached_tail;
+    std::atomic<unsigned long long> dropped;
+    char before_tail[ 64 ];
+    std::atomic<std::size_t> tail;
+    char after_tail[ 64 ];
+};
+
+struct log_format
+{
+    int digits;
+    bool exponential;
+    std::string unit;
+    std::string separator;
+};
+
+/*
+ * the rings, formats and background thread of a logger; the mutex guards
+ * the members that follow it. The serial tells loggers apart in the
+ * per-thread cache of ring_of(), also one at the address of an ended one.
+ */
+struct log_state
+{
+    log_state( eng_logger::sink_type const & sink, std::size_t const capacity )
+    : sink( sink ), capacity( capacity ), serial( next_serial() ), requested( 0 ), completed( 0 ), stopping( false ) {}
+
+    static unsigned long long next_serial()
+    {
+        static std::atomic<unsigned long long> serials( 0 );
+        return ++serials;
+    }
+
+    const eng_logger::sink_type sink;
+    const std::size_t capacity;
+    const unsigned long long serial;
+
+    std::mutex mutex;
+    std::vector< std::pair< std::thread::id, std::unique_ptr<log_ring> > > rings;
+    std::vector<log_format> formats;
+    unsigned long long requested;           // flushes requested
+    unsigned long long completed;           // flushes rendered
+    bool stopping;
+    std::condition_variable wake;
+    std::condition_variable done;
+
+    std::thread consumer;
+};
+
+/*
+ * the ring of the calling thread, created at its first use.
+ */
+ENG_FORMAT_INLINE log_ring & ring_of( log_state & state )
+{
+    struct cache { unsigned long long serial; log_ring * ring; };
+    static thread_local cache last = { 0, nullptr };
+
+    if ( last.serial != state.serial )
+    {
+        const std::thread::id self = std::this_thread::get_id();
+        std::lock_guard<std::mutex> lock( state.mutex );
+
+        last.ring = nullptr;
+
+        for ( std::size_t i = 0; i < state.rings.size() && !last.ring; ++i )
+        {
+            last.ring = self == state.rings[i].first ? state.rings[i].second.get() : nullptr;
+        }
+
+        if ( !last.ring )
+        {
+            state.rings.emplace_back( self, std::unique_ptr<log_ring>( new log_ring( state.capacity ) ) );
+            last.ring = state.rings.back().second.get();
+        }
+        last.serial = state.serial;
+    }
+    return *last.ring;
+}
+
+/*
+ * render the records of a ring and pass them to the sink; formats is the
+ * background thread's copy, renewed for a format added since. Returns
+ * whether there were any.
+ */
+ENG_FORMAT_INLINE bool drain( log_state & state, log_ring & ring, std::vector<log_format> & formats, std::vector<char> & text )
+{
+    std::size_t tail = ring.tail.load( std::memory_order_relaxed );
+    const std::size_t head = ring.head.load( std::memory_order_acquire );
+
+    if ( tail == head )
+    {
+        return false;
+    }
+
+    for ( ; tail != head; )
+    {
+        const log_record record = ring.records[ tail & ring.mask ];
+        ring.tail.store( ++tail, std::memory_order_release );
+
+        if ( record.format >= static_cast<int>( formats.size() ) )
+        {
+            std::lock_guard<std::mutex> lock( state.mutex );
+            formats = state.formats;
+        }
+
+        if ( record.format < 0 || record.format >= static_cast<int>( formats.size() ) )
+        {
+            continue;
+        }
+
+        log_format const & format = formats[ record.format ];
+        std::size_t length;
+
+        while ( ( length = to_engineering_chars( &text[0], text.size(), record.value, format.digits, format.exponential, format.unit.c_str(), format.separator.c_str() ) ) >= text.size() )
+        {
+            text.resize( length + 1 );
+        }
+
+        state.sink( record.format, &text[0], length );
+    }
+    return true;
+}
+
+/*
+ * the background thread: drain all rings, then wait up to a millisecond
+ * unless a flush is requested. A pass that starts after a request renders
+ * everything logged before it.
+ */
+ENG_FORMAT_INLINE void consume( log_state & state )
+{
+    std::vector<log_ring *> rings;
+    std::vector<log_format> formats;
+    std::vector<char> text( 64 );
+
+    for ( ;; )
+    {
+        unsigned long long request;
+        bool stop;
+        {
+            std::lock_guard<std::mutex> lock( state.mutex );
+
+            request = state.requested;
+            stop    = state.stopping;
+
+            for ( std::size_t i = rings.size(); i < state.rings.size(); ++i )
+            {
+                rings.push_back( state.rings[i].second.get() );
+            }
+        }
+
+        bool any = false;
+
+        for ( std::size_t i = 0; i < rings.size(); ++i )
+        {
+            any = drain( state, *rings[i], formats, text ) || any;
+        }
+
+        std::unique_lock<std::mutex> lock( state.mutex );
+
+        if ( state.completed != request )
+        {
+            state.completed = request;
+            state.done.notify_all();
+        }
+
+        if ( stop )
+        {
+            return;
+        }
+
+        if ( !any && state.requested == request && !state.stopping )
+        {
+            state.wake.wait_for( lock, std::chrono::milliseconds( 1 ) );
+        }
+    }
+}
+
+#endif // ENG_FORMAT_CPP11
+
+/*
+ * ticks at 1, 2 or 5 x 10^k apart, labels with the layout of a column.
+ */
+ENG_FORMAT_INLINE eng_ticks_t linear_ticks( double const low, double const high, int const target, double * const values, std::size_t const capacity, char * const labels, std::size_t const label_capacity, char const * const unit, char const * const separator )
+{
+    const double span  = high - low;
+    const double rough = span / (std::max)( target, 1 );
+
+    int exponent = is_zero( rough ) ? ( is_zero( low ) ? 0 : static_cast<int>( floor( log10( fabs( low ) ) ) ) - 2 ) : static_cast<int>( floor( log10( rough ) ) );
+    const double mantissa = rough / pow( 10.0, exponent );
+
+    int step = mantissa < 1.5 ? 1 : mantissa < 3.5 ? 2 : mantissa < 7.5 ? 5 : 10;
+    if ( 10 == step )
+    {
+        step = 1;
+        ++exponent;
+    }
+
+    // tick numbers in units of 10^exponent, allowing for rounding of low and high:
+    const double unit_step = scaled( step, exponent );
+    const double first = step * ceil ( low  / unit_step - 1e-9 ) + 0.0;   // not -0
+    const double last  = step * floor( high / unit_step + 1e-9 );
+
+    eng_ticks_t ticks = { 0, 0, 0 };
+
+    if ( last < first )
+    {
+        return ticks;
+    }
+
+    ticks.count = static_cast<std::size_t>( ( last - first ) / step + 0.5 ) + 1;
+
+    // the largest magnitude is at an end; its digits down to the step:
+    const double ends[] = { scaled( first, exponent ), scaled( last, exponent ) };
+
+    decimal largest;
+    to_decimal( (std::max)( fabs( ends[0] ), fabs( ends[1] ) ), 17, largest );
+
+    const int digits = is_zero( ends[0] ) && is_zero( ends[1] ) ? 1 : (std::max)( largest.exponent - exponent + 1, 1 );
+    const eng_column_t column = eng_column( ends, 2, digits, false, unit, separator );
+
+    ticks.width  = column.width;
+    ticks.length = ticks.count * column.width;
+
+    if ( ticks.count <= capacity )
+    {
+        for ( std::size_t i = 0; i < ticks.count; ++i )
+        {
+            values[i] = scaled( first + static_cast<double>( i ) * step, exponent );
+        }
+        to_engineering_column( labels, label_capacity, values, ticks.count, column, false, unit, separator );
+    }
+
+    return ticks;
+}
+
+/*
+ * ticks at powers of ten, every stride decades, each label with its own prefix.
+ */
+ENG_FORMAT_INLINE eng_ticks_t decade_ticks( double const low, double const high, int const target, double * const values, std::size_t const capacity, char * const labels, std::size_t const label_capacity, char const * const unit, char const * const separator )
+{
+    int first = static_cast<int>( floor( log10( low  ) ) );
+    int last  = static_cast<int>( floor( log10( high ) ) );
+
+    first += scaled( 1, first ) < low;
+    last  += scaled( 1, last + 1 ) <= high;
+    last  -= scaled( 1, last ) > high;
+
+    // every 1, 2, 3 or a multiple of 3 decades, from a multiple of it:
+    int stride = (std::max)( ( last - first + target ) / (std::max)( target, 1 ), 1 );
+
+    if ( stride > 2 )
+    {
+        stride = 3 * ( ( stride + 2 ) / 3 );
+    }
+
+    first = stride * static_cast<int>( ceil( static_cast<double>( first ) / stride ) );
+
+    eng_ticks_t ticks = { 0, 0, 0 };
+
+    if ( last < first )
+    {
+        return ticks;
+    }
+
+    ticks.count = static_cast<std::size_t>( ( last - first ) / stride + 1 );
+
+    for ( std::size_t i = 0; i < ticks.count; ++i )
+    {
+        const int width = static_cast<int>( to_engineering_chars( NULL, 0, scaled( 1, first + static_cast<int>( i ) * stride ), 1, false, unit, separator ) );
+        ticks.width = (std::max)( ticks.width, width );
+    }
+
+    ticks.length = ticks.count * ticks.width;
+
+    if ( ticks.count <= capacity )
+    {
+        writer out( labels, label_capacity );
+
+        for ( std::size_t i = 0; i < ticks.count; ++i )
+        {
+            values[i] = scaled( 1, first + static_cast<int>( i ) * stride );
+
+            char label[ 128 ];
+            const std::size_t length = to_engineering_chars( label, sizeof label, values[i], 1, false, unit, separator );
+
+            put_label( out, label, length < sizeof label ? length : static_cast<std::size_t>( ticks.width ) + 1, ticks.width );
+        }
+        out.finish();
+    }
+
+    return ticks;
+}
+
+} // namespace eng_format_detail
+
+/**
+ * convert real number to prefixed or exponential notation, optionally followed by a unit.
+ */
+ENG_FORMAT_INLINE std::string
+to_engineering_string( double const value, int const digits, bool exponential, std::string const unit /*= ""*/, std::string separator /*= " "*/ )
+{
+    char text[ 64 ];
+
+    const std::size_t length = to_engineering_chars( text, sizeof text, value, digits, exponential, unit.c_str(), separator.c_str() );
+
+    if ( length < sizeof text )
+    {
+        return std::string( text, length );
+    }
+
+    std::string result( length + 1, '\0' );
+
+    to_engineering_chars( &result[0], result.size(), value, digits, exponential, unit.c_str(), separator.c_str() );
+
+    result.resize( length );
+    return result;
+}
+
+/**
+ * convert real number to prefixed or exponential notation, optionally followed by a unit,
+ * into the given buffer.
+ */
+ENG_FORMAT_INLINE std::size_t
+to_engineering_chars( char * const buffer, std::size_t const capacity, double const value, int const digits, bool const exponential, char const * const unit /*= ""*/, char const * const separator /*= " "*/ )
+{
+    return eng_format_detail::format_real( buffer, capacity, value, digits, exponential, unit, separator );
+}
+
+/**
+ * convert real number to IEC binary (prefix) notation, optionally followed by a unit.
+ */
+ENG_FORMAT_INLINE std::string
+to_engineering_string( double const value, int const digits, eng_binary_t, std::string const unit /*= ""*/, std::string const separator /*= " "*/ )
+{
+    char text[ 64 ];
+
+    const std::size_t length = to_engineering_chars( text, sizeof text, value, digits, eng_binary_t(), unit.c_str(), separator.c_str() );
+
+    if ( length < sizeof text )
+    {
+        return std::string( text, length );
+    }
+
+    std::string result( length + 1, '\0' );
+
+    to_engineering_chars( &result[0], result.size(), value, digits, eng_binary_t(), unit.c_str(), separator.c_str() );
+
+    result.resize( length );
+    return result;
+}
+
+/**
+ * convert real number to IEC binary (prefix) notation, optionally followed by a unit,
+ * into the given buffer.
+ */
+ENG_FORMAT_INLINE std::size_t
+to_engineering_chars( char * const buffer, std::size_t const capacity, double const value, int const digits, eng_binary_t, char const * const unit /*= ""*/, char const * const separator /*= " "*/ )
+{
+    using namespace eng_format_detail;
+
+    const double magnitude = fabs( value );
+
+    // NaN, infinity, fractions and values from 1024 Yi on have no binary prefix:
+    if ( ! ( magnitude >= 1 && magnitude < ldexp( 1.0, 10 * binary_prefix_count ) ) )
+    {
+        return to_engineering_chars( buffer, capacity, value, digits, false, unit, separator );
+    }
+
+    ENG_FORMAT_COUNT( stat_binary );
+
+    int exponent;
+    frexp( magnitude, &exponent );
+
+    int degree = ( exponent - 1 ) / 10;
+
+    decimal dec;
+    to_binary_decimal( ldexp( value, -10 * degree ), clamp_digits( digits ), dec );
+
+    if ( reaches_next_binary_degree( dec ) )
+    {
+        if ( ++degree == binary_prefix_count )
+        {
+            return to_engineering_chars( buffer, capacity, value, digits, false, unit, separator );
+        }
+        set_to_one( dec, clamp_digits( digits ) );
+    }
+
+    writer out( buffer, capacity );
+    put_binary( out, dec, degree, unit, separator );
+    return out.finish();
+}
+
+/**
+ * convert the output of to_engineering_string() into a double.
+ *
+ * The engineering presentation should not contain a unit, as the first letter
+ * is interpreted as an SI prefix, e.g. "1 T" is 1e12, not 1 (Tesla).
+ *
+ * "1.23 M"   => 1.23e+6
+ * "1.23 kPa" => 1.23e+3  (ok, but not recommended)
+ * "1.23 Pa"  => 1.23e+12 (not what's intended!)
+ */
+ENG_FORMAT_INLINE double from_engineering_string( std::string const text )
+{
+    return from_engineering_chars( text.c_str() );
+}
+
+/**
+ * convert the output of to_engineering_chars() into a double.
+ */
+ENG_FORMAT_INLINE double from_engineering_chars( char const * const text )
+{
+    using namespace eng_format_detail;
+
+    ENG_FORMAT_PROBE1( from_engineering_entry, text );
+    ENG_FORMAT_COUNT( stat_parses );
+
+    char * tail;
+    const double magnitude = strtod( text, &tail );
+
+    if ( tail == text )
+    {
+        ENG_FORMAT_COUNT( stat_parse_failures );
+    }
+
+    char const * const prefix = first_non_space( tail );
+    const int binary_degree   = binary_prefix_to_degree( prefix );
+
+    const double result = binary_degree
+        ? ldexp( magnitude, 10 * binary_degree )
+        : magnitude * powers_of_thousand()[ prefix_count - 1 + prefix_to_exponent( prefix ) / 3 ];
+
+    ENG_FORMAT_PROBE1( from_engineering_return, result );
+
+    return result;
+}
+
+/**
+ * step a value by the smallest possible increment.
+ */
+ENG_FORMAT_INLINE std::string step_engineering_string( std::string const text, int const digits, bool const exponential, bool const positive )
+{
+    char result[ 64 ];
+
+    const std::size_t length = step_engineering_chars( result, sizeof result, text.c_str(), digits, exponential, positive );
+
+    return std::string( result, length < sizeof result ? length : sizeof result - 1 );
+}
+
+/**
+ * step a value by the smallest possible increment, into the given buffer.
+ */
+ENG_FORMAT_INLINE std::size_t step_engineering_chars( char * const buffer, std::size_t const capacity, char const * const text, int digits, bool const exponential, bool const positive )
+{
+    using namespace eng_format_detail;
+
+    ENG_FORMAT_COUNT( stat_steps );
+
+    const double value = from_engineering_chars( text );
+
+    if ( digits < 3 )
     {
         digits = 3;
     }
 
-    // correctly round to desired precision
-    const int expof10 = is_zero(value) ? 0 : lrint( floor( log10( value ) ) );
-    const int   power = expof10 + 1 - digits;
+    // correctly round to desired precision
+    const int expof10 = is_zero(value) ? 0 : lrint( floor( log10( value ) ) );
+    const int   power = expof10 + 1 - digits;
+
+    const double  inc = pow( 10.0, power ) * ( positive ? +1 : -1 );
+    const double  ret = value + inc;
+
+    return to_engineering_chars( buffer, capacity, ret, digits, exponential );
+}
+
+/**
+ * normalize text in prefixed or exponential notation to the specified
+ * number of digits, from its decimal digits.
+ */
+ENG_FORMAT_INLINE std::string normalize_engineering_string( std::string const text, int const digits, bool const exponential, std::string const unit /*= ""*/, std::string const separator /*= " "*/ )
+{
+    char result[ 128 ];
+
+    const std::size_t length = normalize_engineering_chars( result, sizeof result, text.c_str(), digits, exponential, unit.c_str(), separator.c_str() );
+
+    if ( length < sizeof result )
+    {
+        return std::string( result, length );
+    }
+
+    std::string large( length + 1, '\0' );
+    normalize_engineering_chars( &large[0], large.size(), text.c_str(), digits, exponential, unit.c_str(), separator.c_str() );
+    large.resize( length );
+
+    return large;
+}
+
+/**
+ * normalize text in prefixed or exponential notation to the specified
+ * number of digits, from its decimal digits, into the given buffer.
+ */
+ENG_FORMAT_INLINE std::size_t normalize_engineering_chars( char * const buffer, std::size_t const capacity, char const * const text, int const digits, bool const exponential, char const * const unit /*= ""*/, char const * const separator /*= " "*/ )
+{
+    using namespace eng_format_detail;
+
+    writer out( buffer, capacity );
+    transcode( out, text, digits, exponential, unit, separator );
+
+    return out.finish();
+}
+
+/**
+ * normalize many texts into the given buffer, each followed by '\0'.
+ */
+ENG_FORMAT_INLINE std::size_t normalize_engineering_chars( char * const buffer, std::size_t const capacity, char const * const * const texts, std::size_t const count, std::size_t * const offsets, int const digits, bool const exponential, char const * const unit /*= ""*/, char const * const separator /*= " "*/ )
+{
+    using namespace eng_format_detail;
+
+    writer out( buffer, capacity );
+
+    for ( std::size_t i = 0; i < count; ++i )
+    {
+        if ( offsets )
+        {
+            offsets[i] = out.length();
+        }
+
+        transcode( out, texts[i], digits, exponential, unit, separator );
+        out.put( '\0' );
+    }
+
+    return out.finish();
+}
+
+/**
+ * largest magnitude of the finite values, using the chosen vector kernel.
+ */
+ENG_FORMAT_INLINE double eng_max_magnitude( double const * const values, std::size_t const count )
+{
+    return eng_format_detail::kernels().max_magnitude( values, count );
+}
+
+/**
+ * instruction set of the chosen vector kernels.
+ */
+ENG_FORMAT_INLINE char const * eng_format_isa()
+{
+    return eng_format_detail::kernels().isa;
+}
+
+/**
+ * layout of a column: the degree of the largest magnitude, the decimals that
+ * give it digits significant digits, and the width of the widest row.
+ */
+ENG_FORMAT_INLINE eng_column_t eng_column( double const * const values, std::size_t const count, int const digits, bool const exponential, char const * const unit /*= ""*/, char const * const separator /*= " "*/ )
+{
+    using namespace eng_format_detail;
+
+    decimal largest;
+    to_engineering_decimal( eng_max_magnitude( values, count ), clamp_digits( digits ), largest );
+
+    eng_column_t column;
+    column.degree   = degree_of( largest.exponent );
+    column.decimals = (std::max)( clamp_digits( digits ) - integral_digits( largest.exponent ), 0 );
+
+    bool negative = false, nan = false, infinite = false;
+
+    for ( std::size_t i = 0; i < count; ++i )
+    {
+        negative = negative || ( is_negative( values[i] ) && ! is_nan( values[i] ) );
+        nan      = nan      || is_nan( values[i] );
+        infinite = infinite || is_inf( values[i] );
+    }
+
+    writer suffix( NULL, 0 );
+    put_suffix( suffix, column.degree, exponential, unit, separator );
+
+    column.width = static_cast<int>( negative + integral_digits( largest.exponent ) + ( column.decimals ? column.decimals + 1 : 0 ) + suffix.finish() );
+    column.width = (std::max)( column.width, infinite ? 8 : nan ? 3 : 0 );
+
+    return column;
+}
+
+/**
+ * format values with the degree and decimals of the column, each right-aligned
+ * in column.width characters, rows one after the other; a row that does not
+ * fit is filled with '#'.
+ */
+ENG_FORMAT_INLINE std::size_t to_engineering_column( char * const buffer, std::size_t const capacity, double const * const values, std::size_t const count, eng_column_t const column, bool const exponential, char const * const unit /*= ""*/, char const * const separator /*= " "*/ )
+{
+    using namespace eng_format_detail;
+
+    const int place  = 3 * column.degree - column.decimals;
+    const int width  = (std::max)( column.width, 0 );
+
+    writer suffix( NULL, 0 );
+    put_suffix( suffix, column.degree, exponential, unit, separator );
+
+    const int fraction = column.decimals ? column.decimals + 1 : 0;
+    const int tail     = fraction + static_cast<int>( suffix.finish() );
+
+    writer out( buffer, capacity );
+
+    for ( std::size_t row = 0; row < count; ++row )
+    {
+        const double value = values[ row ];
+
+        if ( exponential ) { ENG_FORMAT_COUNT( stat_exponential ); }
+        else               { ENG_FORMAT_COUNT( stat_prefixed    ); }
+
+        char const * special = is_nan( value ) ? "NaN" : is_inf( value ) ? "INFINITE" : NULL;
+
+        decimal dec;
+        int length;
+
+        if ( special )
+        {
+            length = static_cast<int>( strlen( special ) );
+        }
+        else
+        {
+            round_to_place( value, place, dec );
+            length = dec.negative + (std::max)( dec.exponent - 3 * column.degree + 1, 1 ) + tail;
+        }
+
+        if ( length > width )
+        {
+            for ( int i = 0; i < width; ++i )
+            {
+                out.put( '#' );
+            }
+            continue;
+        }
+
+        for ( int i = length; i < width; ++i )
+        {
+            out.put( ' ' );
+        }
+
+        if ( special )
+        {
+            out.put( special );
+        }
+        else
+        {
+            put_fixed( out, dec, column.degree, place );
+            put_suffix( out, column.degree, exponential, unit, separator );
+        }
+    }
+
+    return out.finish();
+}
 
-    const double  inc = pow( 10.0, power ) * ( positive ? +1 : -1 );
-    const double  ret = value + inc;
+/**
+ * ticks for an axis from low to high with labels: at 1, 2 or 5 x 10^k apart
+ * with one degree and number of decimals, or at powers of ten each with its
+ * own prefix.
+ */
+ENG_FORMAT_INLINE eng_ticks_t eng_axis_ticks( double low, double high, int const target, bool const logarithmic, double * const values, std::size_t const capacity, char * const labels, std::size_t const label_capacity, char const * const unit /*= ""*/, char const * const separator /*= " "*/ )
+{
+    using namespace eng_format_detail;
+
+    if ( low > high )
+    {
+        std::swap( low, high );
+    }
+
+    if ( is_nan( low ) || is_nan( high ) || is_inf( low ) || is_inf( high ) || ( logarithmic && !( low > 0 ) ) )
+    {
+        const eng_ticks_t none = { 0, 0, 0 };
+        return none;
+    }
+
+    return logarithmic
+        ? decade_ticks( low, high, target, values, capacity, labels, label_capacity, unit, separator )
+        : linear_ticks( low, high, target, values, capacity, labels, label_capacity, unit, separator );
+}
+
+/**
+ * a display for one channel that keeps its degree within hysteresis.
+ */
+ENG_FORMAT_INLINE eng_display_t eng_display( int const digits, double const hysteresis, bool const exponential, char const * const unit /*= ""*/, char const * const separator /*= " "*/ )
+{
+    // low above high: the first value chooses the degree:
+    const eng_display_t display = { digits, hysteresis, exponential, unit, separator, 0, 1, 0 };
+    return display;
+}
+
+/**
+ * format the next value of a display, keeping the degree shown last while
+ * the magnitude is within range.
+ */
+ENG_FORMAT_INLINE std::size_t to_engineering_display( char * const buffer, std::size_t const capacity, eng_display_t & display, double const value )
+{
+    using namespace eng_format_detail;
+
+    if ( is_nan( value ) || is_inf( value ) )
+    {
+        return format_real( buffer, capacity, value, display.digits, display.exponential, display.unit, display.separator );
+    }
+
+    if ( display.exponential ) { ENG_FORMAT_COUNT( stat_exponential ); }
+    else                       { ENG_FORMAT_COUNT( stat_prefixed    ); }
+
+    const int    digits    = clamp_digits( display.digits );
+    const double magnitude = fabs( value );
+
+    writer out( buffer, capacity );
+    decimal dec;
+
+    if ( !( is_zero( value ) || ( display.low <= magnitude && magnitude < display.high ) ) )
+    {
+        to_engineering_decimal( value, digits, dec );
+
+        // the range of magnitudes that round into the degree, widened by hysteresis:
+        const double half = 1 - 0.5 * scaled( 1, -digits );
+
+        display.degree = degree_of( dec.exponent );
+        display.low    = half * power_of_thousand( display.degree     ) * ( 1 - display.hysteresis );
+        display.high   = half * power_of_thousand( display.degree + 1 ) * ( 1 + display.hysteresis );
+
+        put_engineering( out, dec, display.exponential, display.unit, display.separator );
+
+        return out.finish();
+    }
+
+    // within range, in the degree kept: the same significant digits, but no
+    // fewer than the integral ones; zero down to the place of those digits:
+    int place = 3 * display.degree - digits + 1;
+
+    if ( is_zero( value ) )
+    {
+        set_to_place( dec, is_negative( value ), place, false );
+    }
+#if ENG_FORMAT_CPP11
+    else if ( display_digits( magnitude, digits, display.degree, dec, place ) )
+    {
+        dec.negative = is_negative( value );
+    }
+#endif
+    else
+    {
+        // log10() may be one off, and rounding may carry into the next power
+        // of ten, which the exponent of the result shows:
+        const int guess = static_cast<int>( floor( log10( magnitude ) ) );
+        place = (std::min)( guess - digits + 1, 3 * display.degree );
+
+        round_to_place( value, place, dec );
+
+        if ( dec.count > 0 && place != (std::min)( dec.exponent - digits + 1, 3 * display.degree ) )
+        {
+            place = (std::min)( dec.exponent - digits + 1, 3 * display.degree );
+            round_to_place( value, place, dec );
+        }
+
+        // fewer significant digits than integral ones: as to_engineering_decimal(),
+        // 96 with 1 digit shows 100, if that stays within the degree:
+        if ( dec.exponent - digits + 1 > place && dec.exponent < 3 * display.degree + 2 )
+        {
+            decimal probe;
+            to_decimal( value, digits, probe );
+
+            if ( probe.exponent > dec.exponent )
+            {
+                dec = probe;
+            }
+        }
+    }
+
+    put_fixed( out, dec, display.degree, place );
+    put_suffix( out, display.degree, display.exponential, display.unit, display.separator );
+
+    return out.finish();
+}
+
+/**
+ * the parts of the text of a value: sign, digits, decimal point, degree and
+ * prefix or exponent.
+ */
+ENG_FORMAT_INLINE eng_parts_t eng_parts( double const value, int const digits, bool const exponential )
+{
+    using namespace eng_format_detail;
+
+    if ( exponential ) { ENG_FORMAT_COUNT( stat_exponential ); }
+    else               { ENG_FORMAT_COUNT( stat_prefixed    ); }
+
+    eng_parts_t parts = { false, 0, "", 0, 0, 0, NULL, NULL };
+
+    if      ( is_nan( value ) ) { ENG_FORMAT_COUNT( stat_nan      ); parts.special = "NaN";      return parts; }
+    else if ( is_inf( value ) ) { ENG_FORMAT_COUNT( stat_infinite ); parts.special = "INFINITE"; return parts; }
+
+    decimal dec;
+    to_engineering_decimal( value, clamp_digits( digits ), dec );
+
+    parts.negative = dec.negative;
+    parts.count    = dec.count;
+    parts.point    = integral_digits( dec.exponent );
+    parts.degree   = degree_of( dec.exponent );
+    parts.exponent = 3 * parts.degree;
+
+    memcpy( parts.digits, dec.digits, dec.count );
+    parts.digits[ dec.count ] = '\0';
+
+    if ( ! exponential )
+    {
+        if ( abs( parts.degree ) < prefix_count )
+        {
+            parts.prefix = si_prefix( parts.degree );
+        }
+        else
+        {
+            ENG_FORMAT_COUNT( stat_exponent_fallback );
+        }
+    }
+
+    return parts;
+}
+
+/**
+ * a memcmp-orderable key of text in prefixed or exponential notation: the
+ * class, the biased exponent of the first digit, and digits in BCD.
+ */
+ENG_FORMAT_INLINE eng_sort_key_t eng_sort_key( char const * const text, char const * const unit /*= ""*/ )
+{
+    using namespace eng_format_detail;
+
+    ENG_FORMAT_COUNT( stat_parses );
+
+    eng_sort_key_t key;
+    memset( key.bytes, 0, sizeof key.bytes );
+
+    exact_number number;
+    text_kind kind = read_engineering( text, unit, number );
+
+    if ( text_binary == kind )
+    {
+        // more digits than the key holds:
+        decimal dec;
+        to_decimal( from_engineering_chars( text ), 17, dec );
+        to_exact( dec, number );
+        kind = text_exact;
+    }
+
+    switch ( kind )
+    {
+        case text_none:     ENG_FORMAT_COUNT( stat_parse_failures ); key.bytes[0] = sort_none; return key;
+        case text_nan:      key.bytes[0] = sort_nan; return key;
+        case text_infinite: key.bytes[0] = number.negative ? sort_minus_infinity : sort_plus_infinity; return key;
+        default:            break;
+    }
+
+    if ( 0 == number.count )
+    {
+        key.bytes[0] = sort_zero;
+        return key;
+    }
+
+    const int biased = (std::max)( (std::min)( number.exponent + 0x8000, 0xffff ), 0 );
+
+    key.bytes[0] = number.negative ? sort_negative : sort_positive;
+    key.bytes[1] = static_cast<unsigned char>( biased >> 8 );
+    key.bytes[2] = static_cast<unsigned char>( biased & 0xff );
+
+    const int count = (std::min)( number.count, 2 * ( eng_sort_key_size - 3 ) );
+
+    for ( int i = 0; i < count; ++i )
+    {
+        key.bytes[ 3 + i / 2 ] |= static_cast<unsigned char>( ( number.digits[i] - '0' ) << ( i % 2 ? 0 : 4 ) );
+    }
+
+    // a larger magnitude is a smaller negative number:
+    if ( number.negative )
+    {
+        for ( int i = 1; i < eng_sort_key_size; ++i )
+        {
+            key.bytes[i] = static_cast<unsigned char>( ~key.bytes[i] );
+        }
+    }
+
+    return key;
+}
+
+/**
+ * order of sort keys, as memcmp() gives it.
+ */
+ENG_FORMAT_INLINE bool operator<( eng_sort_key_t const & a, eng_sort_key_t const & b )
+{
+    return memcmp( a.bytes, b.bytes, sizeof a.bytes ) < 0;
+}
+
+#if ENG_FORMAT_CPP11
 
-    return to_engineering_string( ret, digits, exponential );
+/**
+ * the key of the text of a value: the digits shown as an integer, the
+ * exponent of the last digit, the degree and the sign.
+ */
+ENG_FORMAT_INLINE eng_key_t eng_key( double const value, int const digits )
+{
+    using namespace eng_format_detail;
+
+    const int count = digits < 1 ? 1 : digits > 19 ? 19 : digits;
+
+    eng_key_t key = { false, std::numeric_limits<int>::max(), std::numeric_limits<int>::max(), 0 };
+
+    if ( is_nan( value ) || is_inf( value ) )
+    {
+        key.mantissa = is_nan( value );
+        return key;
+    }
+
+    key.negative = is_negative( value );
+
+    int exponent = 0, shown = count;
+
+    if ( !scaled_engineering_digits( fabs( value ), count, key.mantissa, exponent, shown ) )
+    {
+        decimal dec;
+        to_engineering_decimal( value, count, dec );
+
+        key.mantissa = integer_of( dec );
+        exponent = dec.exponent;
+        shown    = dec.count;
+    }
+
+    key.degree   = degree_of( exponent );
+    key.exponent = exponent - shown + 1;
+
+    return key;
+}
+
+/**
+ * the key of the text of a value in binary notation: the digits shown, the
+ * exponent of the last one in units of 1024^degree, the degree and the sign.
+ */
+ENG_FORMAT_INLINE eng_key_t eng_key( double const value, int const digits, eng_binary_t )
+{
+    using namespace eng_format_detail;
+
+    const double magnitude = fabs( value );
+
+    // as to_engineering_chars(): no binary prefix, the text is decimal:
+    if ( ! ( magnitude >= 1 && magnitude < ldexp( 1.0, 10 * binary_prefix_count ) ) )
+    {
+        return eng_key( value, digits );
+    }
+
+    int exponent;
+    frexp( magnitude, &exponent );
+
+    int degree = ( exponent - 1 ) / 10;
+
+    decimal dec;
+    to_binary_decimal( ldexp( value, -10 * degree ), clamp_digits( digits ), dec );
+
+    if ( reaches_next_binary_degree( dec ) )
+    {
+        if ( ++degree == binary_prefix_count )
+        {
+            return eng_key( value, digits );
+        }
+        set_to_one( dec, clamp_digits( digits ) );
+    }
+
+    const eng_key_t key = { dec.negative, degree, dec.exponent - dec.count + 1, integer_of( dec ) };
+    return key;
+}
+
+/**
+ * sort texts in prefixed or exponential notation by value, using their sort
+ * keys, on the specified number of threads.
+ */
+ENG_FORMAT_INLINE void eng_sort( char const ** const texts, std::size_t const count, char const * const unit /*= ""*/, unsigned const threads /*= 0*/ )
+{
+    eng_format_detail::sort_texts( texts, count, unit, threads );
+}
+
+/**
+ * sort strings in prefixed or exponential notation by value, using their
+ * sort keys, on the specified number of threads.
+ */
+ENG_FORMAT_INLINE void eng_sort( std::string * const texts, std::size_t const count, char const * const unit /*= ""*/, unsigned const threads /*= 0*/ )
+{
+    eng_format_detail::sort_texts( texts, count, unit, threads );
+}
+
+/**
+ * start the background thread; each ring holds capacity values, rounded up
+ * to a power of two.
+ */
+ENG_FORMAT_INLINE eng_logger::eng_logger( sink_type sink, std::size_t const capacity /*= 4096*/ )
+{
+    std::size_t size = 2;
+
+    while ( size < capacity )
+    {
+        size *= 2;
+    }
+
+    state.reset( new eng_format_detail::log_state( sink, size ) );
+    state->consumer = std::thread( eng_format_detail::consume, std::ref( *state ) );
+}
+
+/**
+ * render what was logged and stop the background thread.
+ */
+ENG_FORMAT_INLINE eng_logger::~eng_logger()
+{
+    {
+        std::lock_guard<std::mutex> lock( state->mutex );
+        state->stopping = true;
+    }
+    state->wake.notify_one();
+    state->consumer.join();
+}
+
+/**
+ * register a format and return its id, for log().
+ */
+ENG_FORMAT_INLINE int eng_logger::add_format( int const digits, bool const exponential, char const * const unit /*= ""*/, char const * const separator /*= " "*/ )
+{
+    std::lock_guard<std::mutex> lock( state->mutex );
+
+    const eng_format_detail::log_format format = { digits, exponential, unit, separator };
+    state->formats.push_back( format );
+
+    return static_cast<int>( state->formats.size() ) - 1;
+}
+
+/**
+ * create the ring of the calling thread, so that its first log() does not
+ * allocate.
+ */
+ENG_FORMAT_INLINE void eng_logger::prepare()
+{
+    eng_format_detail::ring_of( *state );
+}
+
+/**
+ * capture a value in the ring of the calling thread: a store of the record
+ * and a release store of the head; tail is read only when the ring looks
+ * full.
+ */
+ENG_FORMAT_INLINE bool eng_logger::log( int const format, double const value )
+{
+    using namespace eng_format_detail;
+
+    log_ring & ring = ring_of( *state );
+    const std::size_t head = ring.head.load( std::memory_order_relaxed );
+
+    if ( head - ring.cached_tail > ring.mask )
+    {
+        ring.cached_tail = ring.tail.load( std::memory_order_acquire );
+
+        if ( head - ring.cached_tail > ring.mask )
+        {
+            ring.dropped.store( ring.dropped.load( std::memory_order_relaxed ) + 1, std::memory_order_relaxed );
+            return false;
+        }
+    }
+
+    const log_record record = { value, format };
+    ring.records[ head & ring.mask ] = record;
+    ring.head.store( head + 1, std::memory_order_release );
+
+    return true;
+}
+
+/**
+ * wait until everything logged before the call reached the sink.
+ */
+ENG_FORMAT_INLINE void eng_logger::flush()
+{
+    std::unique_lock<std::mutex> lock( state->mutex );
+
+    const unsigned long long request = ++state->requested;
+    state->wake.notify_one();
+
+    while ( state->completed < request )
+    {
+        state->done.wait( lock );
+    }
+}
+
+/**
+ * the number of values dropped because a ring was full.
+ */
+ENG_FORMAT_INLINE unsigned long long eng_logger::dropped() const
+{
+    std::lock_guard<std::mutex> lock( state->mutex );
+
+    unsigned long long sum = 0;
+
+    for ( std::size_t i = 0; i < state->rings.size(); ++i )
+    {
+        sum += state->rings[i].second->dropped.load( std::memory_order_relaxed );
+    }
+    return sum;
+}
+
+#endif // ENG_FORMAT_CPP11
+
+#if ENG_FORMAT_STATS
+
+/**
+ * snapshot of the usage counts of all threads.
+ */
+ENG_FORMAT_INLINE eng_format_stats eng_format_statistics()
+{
+    using namespace eng_format_detail;
+
+    unsigned long long sum[ stat_counter_count ];
+
+    stat_registry & reg = registry();
+    {
+        std::lock_guard<std::mutex> lock( reg.mutex );
+
+        for ( int i = 0; i < stat_counter_count; ++i )
+        {
+            sum[i] = reg.ended[i];
+        }
+
+        for ( stat_block const * block = reg.first; block; block = block->next )
+        {
+            for ( int i = 0; i < stat_counter_count; ++i )
+            {
+                sum[i] += block->counts[i].load( std::memory_order_relaxed );
+            }
+        }
+    }
+
+    eng_format_stats result =
+    {
+        sum[ stat_prefixed  ], sum[ stat_exponential ], sum[ stat_binary ], sum[ stat_exponent_fallback ],
+        sum[ stat_nan       ], sum[ stat_infinite    ],
+        sum[ stat_parses    ], sum[ stat_parse_failures ], sum[ stat_steps ],
+    };
+    return result;
 }
 
+#endif // ENG_FORMAT_STATS
+
+// included by eng_format.hpp: keep the internal macros out of the user's code.
+#ifdef ENG_FORMAT_HEADER_ONLY
+# undef ENG_FORMAT_PROBE1
+# undef ENG_FORMAT_PROBE3
+# undef ENG_FORMAT_COUNT
+# undef ENG_FORMAT_DIMENSION_OF
+# if defined( _MSC_VER ) && _MSC_VER < 1900
+#  undef snprintf
+# endif
+#endif
+
 // end of file
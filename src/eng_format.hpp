@@ -23,8 +23,69 @@
 #ifndef ENG_FORMAT_H_INCLUDED
 #define ENG_FORMAT_H_INCLUDED
 
+#include <cstddef>
 #include <string>
 
+/*
+ * Note: define ENG_FORMAT_HEADER_ONLY to use the library without compiling
+ * eng_format.cpp separately: the header then includes the implementation as
+ * inline functions, so that the compiler can inline them at the call site.
+ */
+#ifdef ENG_FORMAT_HEADER_ONLY
+# define ENG_FORMAT_INLINE  inline
+#else
+# define ENG_FORMAT_INLINE
+#endif
+
+/*
+ * Note: define ENG_FORMAT_STATS=1 to count how the library is used, see
+ * eng_format_statistics(); this requires C++11. Without it, the counting
+ * compiles to nothing.
+ */
+#ifndef ENG_FORMAT_STATS
+# define ENG_FORMAT_STATS  0
+#endif
+
+/*
+ * Note: the integer overloads require C++11.
+ */
+#if __cplusplus >= 201103L || ( defined( _MSC_VER ) && _MSC_VER >= 1900 )
+# define ENG_FORMAT_CPP11  1
+#else
+# define ENG_FORMAT_CPP11  0
+#endif
+
+#if ENG_FORMAT_STATS && !ENG_FORMAT_CPP11
+# error ENG_FORMAT_STATS requires C++11
+#endif
+
+/*
+ * Note: the std::pmr overloads require C++17 and <memory_resource>.
+ */
+#ifndef ENG_FORMAT_HAVE_PMR
+# if ( __cplusplus >= 201703L || ( defined( _MSVC_LANG ) && _MSVC_LANG >= 201703L ) ) && defined( __has_include )
+#  if __has_include( <memory_resource> )
+#   define ENG_FORMAT_HAVE_PMR  1
+#  endif
+# endif
+#endif
+
+#ifndef ENG_FORMAT_HAVE_PMR
+# define ENG_FORMAT_HAVE_PMR  0
+#endif
+
+#if ENG_FORMAT_CPP11
+# include <chrono>
+# include <cstdint>
+# include <functional>
+# include <memory>
+# include <type_traits>
+#endif
+
+#if ENG_FORMAT_HAVE_PMR
+# include <memory_resource>
+#endif
+
 /**
  * convert a double to the specified number of digits in SI (prefix) or
  * exponential notation, optionally followed by a unit.
@@ -44,6 +105,35 @@ from_engineering_string( std::string text );
 std::string
 step_engineering_string( std::string text, int digits, bool exponential, bool increment );
 
+/**
+ * \var eng_max_digits
+ * \brief maximum number of significant digits; more digits are reduced to this.
+ */
+
+const int eng_max_digits = 40;
+
+/**
+ * convert a double to the specified number of digits in SI (prefix) or
+ * exponential notation, optionally followed by a unit, into the given buffer.
+ * Does not allocate or throw. Like snprintf(), returns the length of the
+ * complete result, also if it did not fit. Shares no mutable state, so
+ * that throughput scales with the number of threads calling it.
+ */
+std::size_t
+to_engineering_chars( char * buffer, std::size_t capacity, double value, int digits, bool exponential, char const * unit = "", char const * separator = " " );
+
+/**
+ * convert the output of to_engineering_chars() into a double.
+ */
+double
+from_engineering_chars( char const * text );
+
+/**
+ * step a value by the smallest possible increment, into the given buffer.
+ */
+std::size_t
+step_engineering_chars( char * buffer, std::size_t capacity, char const * text, int digits, bool exponential, bool increment );
+
 //
 // Extended interface:
 //
@@ -58,8 +148,24 @@ step_engineering_string( std::string text, int digits, bool exponential, bool in
  * \brief select exponential presentation: to_engineering_string(), step_engineering_string().
  */
 
-extern struct eng_prefixed_t {} eng_prefixed;
-extern struct eng_exponential_t {} eng_exponential;
+/**
+ * \var eng_binary
+ * \brief select IEC binary (prefix) presentation, Ki, Mi, Gi ... Yi: to_engineering_string().
+ */
+
+struct eng_prefixed_t {};
+struct eng_exponential_t {};
+struct eng_binary_t {};
+
+#ifdef ENG_FORMAT_HEADER_ONLY
+const eng_prefixed_t eng_prefixed = eng_prefixed_t();
+const eng_exponential_t eng_exponential = eng_exponential_t();
+const eng_binary_t eng_binary = eng_binary_t();
+#else
+extern eng_prefixed_t eng_prefixed;
+extern eng_exponential_t eng_exponential;
+extern eng_binary_t eng_binary;
+#endif
 
 /**
  * \var eng_increment
@@ -112,4 +218,1248 @@ step_engineering_string( std::string text, int digits, eng_exponential_t, bool i
     return step_engineering_string( text, digits, true, increment );
 }
 
+/**
+ * convert a double to the specified number of digits in SI (prefix) notation,
+ * optionally followed by a unit, into the given buffer.
+ */
+inline std::size_t
+to_engineering_chars( char * buffer, std::size_t capacity, double value, int digits, eng_prefixed_t, char const * unit = "", char const * separator = " " )
+{
+    return to_engineering_chars( buffer, capacity, value, digits, false, unit, separator );
+}
+
+/**
+ * convert a double to the specified number of digits in exponential notation,
+ * optionally followed by a unit, into the given buffer.
+ */
+inline std::size_t
+to_engineering_chars( char * buffer, std::size_t capacity, double value, int digits, eng_exponential_t, char const * unit = "", char const * separator = " " )
+{
+    return to_engineering_chars( buffer, capacity, value, digits, true, unit, separator );
+}
+
+/**
+ * convert a double to the specified number of digits in IEC binary (prefix)
+ * notation, 1024-based, optionally followed by a unit: 1536 gives "1.50 Ki".
+ * Values below 1 and from 1024 Yi on have no binary prefix and are written
+ * in SI notation.
+ */
+std::string
+to_engineering_string( double value, int digits, eng_binary_t, std::string unit = "", std::string separator = " " );
+
+/**
+ * convert a double to the specified number of digits in IEC binary (prefix)
+ * notation, optionally followed by a unit, into the given buffer.
+ */
+std::size_t
+to_engineering_chars( char * buffer, std::size_t capacity, double value, int digits, eng_binary_t, char const * unit = "", char const * separator = " " );
+
+/**
+ * step a value by the smallest possible increment, using SI notation, into the given buffer.
+ */
+inline std::size_t
+step_engineering_chars( char * buffer, std::size_t capacity, char const * text, int digits, eng_prefixed_t, bool increment )
+{
+    return step_engineering_chars( buffer, capacity, text, digits, false, increment );
+}
+
+/**
+ * step a value by the smallest possible increment, using exponential notation, into the given buffer.
+ */
+inline std::size_t
+step_engineering_chars( char * buffer, std::size_t capacity, char const * text, int digits, eng_exponential_t, bool increment )
+{
+    return step_engineering_chars( buffer, capacity, text, digits, true, increment );
+}
+
+/**
+ * largest magnitude of the finite values, ignoring NaN and infinity; 0 if
+ * there are none. Uses the widest vector instructions the CPU supports.
+ */
+double
+eng_max_magnitude( double const * values, std::size_t count );
+
+/**
+ * instruction set of the vector kernels chosen at the first use: "avx512",
+ * "avx2", "sse2" or "generic". Environment variable ENG_FORMAT_ISA selects
+ * another one the CPU supports, e.g. ENG_FORMAT_ISA=generic for comparison.
+ */
+char const *
+eng_format_isa();
+
+/**
+ * \struct eng_column_t
+ * \brief layout shared by a column of values, see eng_column().
+ */
+struct eng_column_t
+{
+    int degree;     ///< degree of the prefix or exponent, 3 x degree
+    int decimals;   ///< digits after the decimal point
+    int width;      ///< characters per row; may be made wider
+};
+
+/**
+ * first pass over a column: one degree for all values, that of the largest
+ * magnitude, found with eng_max_magnitude(), rounded to the specified number
+ * of digits; the decimals that give it that many digits; and the width of
+ * the widest row, including a unit: 12.3e3, 0.45e3 and 1.2e6 with 3 digits
+ * give degree 2 (M), 2 decimals, and rows "0.01 M", "0.00 M" and "1.20 M".
+ */
+eng_column_t
+eng_column( double const * values, std::size_t count, int digits, bool exponential, char const * unit = "", char const * separator = " " );
+
+/**
+ * second pass over a column: format all values with the degree and decimals
+ * of the column, each right-aligned in column.width characters, the rows one
+ * after the other, without separation: row i starts at buffer + i * width.
+ * A row that does not fit is filled with '#'. Like snprintf(), returns the
+ * length of the complete result, count x width.
+ */
+std::size_t
+to_engineering_column( char * buffer, std::size_t capacity, double const * values, std::size_t count, eng_column_t column, bool exponential, char const * unit = "", char const * separator = " " );
+
+/**
+ * \struct eng_ticks_t
+ * \brief ticks of an axis, see eng_axis_ticks().
+ */
+struct eng_ticks_t
+{
+    std::size_t count;  ///< number of ticks, also when more than fit
+    int width;          ///< characters per label
+    std::size_t length; ///< length of all labels, count x width
+};
+
+/**
+ * ticks for an axis from low to high, about target of them: on a linear axis
+ * at 1, 2 or 5 x 10^k apart, labels with the layout of a column, one degree
+ * and one number of decimals: 0 to 1.2e3 gives "0.0 k", "0.2 k" ... "1.2 k";
+ * on a logarithmic axis at powers of ten, every so many decades, each label
+ * with its own prefix: 1e-3 to 1e3 gives "1 m", "10 m" ... "1 k". Tick i is
+ * values[i], its label right-aligned at labels + i x width. When there are
+ * more than capacity ticks, writes nothing; returns the ticks and the length
+ * of their labels either way, so that the caller can try again.
+ */
+eng_ticks_t
+eng_axis_ticks( double low, double high, int target, bool logarithmic, double * values, std::size_t capacity, char * labels, std::size_t label_capacity, char const * unit = "", char const * separator = " " );
+
+/**
+ * \struct eng_display_t
+ * \brief a live display of one channel, see eng_display().
+ */
+struct eng_display_t
+{
+    int digits;             ///< significant digits
+    double hysteresis;      ///< fraction beyond the range of a degree before leaving it
+    bool exponential;       ///< exponential instead of prefixed notation
+    char const * unit;      ///< unit
+    char const * separator; ///< separator between number and prefix or exponent
+    int degree;             ///< degree shown last
+    double low;             ///< magnitudes from low up to, not including,
+    double high;            ///< high keep the degree shown last
+};
+
+/**
+ * a display for one channel of successive values, e.g. a live readout:
+ * keeps the degree shown last while the magnitude stays within hysteresis,
+ * a fraction such as 0.01, of the range of that degree, so that a value
+ * around 1 V does not flicker between "999 mV" and "1.00 V".
+ */
+eng_display_t
+eng_display( int digits, double hysteresis, bool exponential, char const * unit = "", char const * separator = " " );
+
+/**
+ * format the next value of a display: in the degree shown last while its
+ * magnitude is within the range kept, found with two comparisons, and rounded
+ * once to its place in that degree; otherwise in its own degree, which is then
+ * kept. Zero keeps the degree, "0.00 mV". Beyond the range of its degree, a
+ * value shows with more integral digits, "1004 mV", or with fewer, "0.990 V".
+ * Like snprintf(), returns the length of the complete result.
+ */
+std::size_t
+to_engineering_display( char * buffer, std::size_t capacity, eng_display_t & display, double value );
+
+/**
+ * \struct eng_parts_t
+ * \brief the parts of the text of a value, see eng_parts().
+ */
+struct eng_parts_t
+{
+    bool negative;                      ///< sign
+    int count;                          ///< number of digits, 0 for NaN and infinity
+    char digits[ eng_max_digits + 1 ];  ///< the digits, without decimal point, NUL-terminated
+    int point;                          ///< number of digits before the decimal point
+    int degree;                         ///< degree of the prefix or exponent
+    int exponent;                       ///< the exponent, 3 x degree
+    char const * prefix;                ///< SI prefix, "" for degree 0; NULL where the exponent applies
+    char const * special;               ///< "NaN" or "INFINITE", otherwise NULL
+};
+
+/**
+ * the parts of the text of a value with the specified number of digits in
+ * prefixed or exponential notation, for a renderer that draws them itself:
+ * -1234.5 with 3 digits gives negative, digits "123", point 1, degree 1,
+ * exponent 3 and prefix "k", which to_engineering_chars() writes as
+ * "-1.23 k". In exponential notation, and beyond the prefixes, prefix is
+ * NULL.
+ */
+eng_parts_t
+eng_parts( double value, int digits, bool exponential );
+
+/**
+ * normalize text in prefixed or exponential notation, such as "1234 Pa" or
+ * "0.0047 u", to the specified number of digits in prefixed or exponential
+ * notation, with the unit: "1.23 kPa", "4.70 n". Shifts the decimal point
+ * and rounds half to even on the decimal digits of the text, so that the
+ * result is exact, without the rounding of a double. A unit in the text is
+ * recognized when it is the specified one; otherwise its first letter may
+ * be taken for a prefix, as by from_engineering_string(). Text with a binary
+ * prefix goes through a double. Text without a number gives "".
+ */
+std::string
+normalize_engineering_string( std::string text, int digits, bool exponential, std::string unit = "", std::string separator = " " );
+
+/**
+ * normalize text to the specified number of digits in SI (prefix) notation.
+ */
+inline std::string
+normalize_engineering_string( std::string text, int digits, eng_prefixed_t, std::string unit = "", std::string separator = " " )
+{
+    return normalize_engineering_string( text, digits, false, unit, separator );
+}
+
+/**
+ * normalize text to the specified number of digits in exponential notation.
+ */
+inline std::string
+normalize_engineering_string( std::string text, int digits, eng_exponential_t, std::string unit = "", std::string separator = " " )
+{
+    return normalize_engineering_string( text, digits, true, unit, separator );
+}
+
+/**
+ * normalize text in prefixed or exponential notation to the specified number
+ * of digits, into the given buffer. Like snprintf(), returns the length of
+ * the complete result.
+ */
+std::size_t
+normalize_engineering_chars( char * buffer, std::size_t capacity, char const * text, int digits, bool exponential, char const * unit = "", char const * separator = " " );
+
+/**
+ * normalize count texts into the given buffer, one after the other, each
+ * followed by '\0'; the result for texts[i] starts at buffer + offsets[i],
+ * if offsets is not NULL. Returns the length of the complete result, with
+ * the '\0's; it fits when that is less than capacity.
+ */
+std::size_t
+normalize_engineering_chars( char * buffer, std::size_t capacity, char const * const * texts, std::size_t count, std::size_t * offsets, int digits, bool exponential, char const * unit = "", char const * separator = " " );
+
+/**
+ * \var eng_sort_key_size
+ * \brief number of bytes of a sort key, see eng_sort_key().
+ */
+const int eng_sort_key_size = 16;
+
+/**
+ * \struct eng_sort_key_t
+ * \brief a key that memcmp() orders as the value of its text.
+ */
+struct eng_sort_key_t
+{
+    unsigned char bytes[ eng_sort_key_size ];
+};
+
+/**
+ * the sort key of text in prefixed or exponential notation, in one pass:
+ * comparing the keys of texts with memcmp() orders them by value, as in
+ * "sort -h": text without a number first, then minus infinity, negative
+ * values, zero, positive values, infinity, and NaN last. The key holds the
+ * sign, the exponent including the prefix, and the first 26 digits; values
+ * that differ only beyond those compare equal. A unit in the text is
+ * recognized when it is the specified one, as by normalize_engineering_chars().
+ */
+eng_sort_key_t
+eng_sort_key( char const * text, char const * unit = "" );
+
+/**
+ * order of sort keys, as memcmp() gives it.
+ */
+bool
+operator<( eng_sort_key_t const & a, eng_sort_key_t const & b );
+
+#if ENG_FORMAT_CPP11
+
+namespace eng_format_detail
+{
+
+template< typename T, typename R >
+struct if_integer : std::enable_if< std::is_integral<T>::value && !std::is_same<T, bool>::value, R > {};
+
+template< typename T >
+bool is_negative_integer( T const value, std::true_type  ) { return value < 0; }
+
+template< typename T >
+bool is_negative_integer( T const    , std::false_type ) { return false; }
+
+template< typename T >
+std::uint64_t magnitude_of( T const value )
+{
+    return is_negative_integer( value, std::is_signed<T>() )
+        ? 0 - static_cast<std::uint64_t>( value ) : static_cast<std::uint64_t>( value );
+}
+
+std::size_t
+binary_to_chars( char * buffer, std::size_t capacity, bool negative, std::uint64_t magnitude, int digits, char const * unit, char const * separator );
+
+std::size_t
+integer_to_chars( char * buffer, std::size_t capacity, bool negative, std::uint64_t magnitude, int exponent, int digits, bool exponential, char const * unit, char const * separator );
+
+template< typename T, typename R >
+struct if_float_or_long_double : std::enable_if< std::is_same<T, float>::value || std::is_same<T, long double>::value, R > {};
+
+std::size_t
+real_to_chars( char * buffer, std::size_t capacity, float value, int digits, bool exponential, char const * unit, char const * separator );
+
+std::size_t
+real_to_chars( char * buffer, std::size_t capacity, long double value, int digits, bool exponential, char const * unit, char const * separator );
+
+float
+real_from_chars( char const * text, float );
+
+long double
+real_from_chars( char const * text, long double );
+
+inline double
+real_from_chars( char const * text, double )
+{
+    return from_engineering_chars( text );
+}
+
+} // namespace eng_format_detail
+
+/**
+ * \struct eng_decimal_t
+ * \brief a scaled integer, value x 10^exponent, such as a reading in
+ * microvolts: eng_decimal( 1234567, -6 ). Make it with eng_decimal().
+ */
+struct eng_decimal_t
+{
+    bool negative;
+    std::uint64_t magnitude;
+    int exponent;
+};
+
+/**
+ * the scaled integer value x 10^exponent.
+ */
+template< typename T >
+typename eng_format_detail::if_integer<T, eng_decimal_t>::type
+eng_decimal( T value, int exponent )
+{
+    eng_decimal_t result = { eng_format_detail::is_negative_integer( value, std::is_signed<T>() ), eng_format_detail::magnitude_of( value ), exponent };
+    return result;
+}
+
+/**
+ * convert an integer exactly to the specified number of digits in prefixed
+ * or exponential notation, optionally followed by a unit, into the given
+ * buffer. The result looks like that for the double, but the digits come
+ * from integer division, so that integers beyond 2^53 stay exact.
+ */
+template< typename T >
+typename eng_format_detail::if_integer<T, std::size_t>::type
+to_engineering_chars( char * buffer, std::size_t capacity, T value, int digits, bool exponential, char const * unit = "", char const * separator = " " )
+{
+    return eng_format_detail::integer_to_chars( buffer, capacity,
+        eng_format_detail::is_negative_integer( value, std::is_signed<T>() ), eng_format_detail::magnitude_of( value ), 0, digits, exponential, unit, separator );
+}
+
+/**
+ * convert an integer exactly to the specified number of digits in SI (prefix)
+ * notation, optionally followed by a unit, into the given buffer.
+ */
+template< typename T >
+typename eng_format_detail::if_integer<T, std::size_t>::type
+to_engineering_chars( char * buffer, std::size_t capacity, T value, int digits, eng_prefixed_t, char const * unit = "", char const * separator = " " )
+{
+    return to_engineering_chars( buffer, capacity, value, digits, false, unit, separator );
+}
+
+/**
+ * convert an integer exactly to the specified number of digits in exponential
+ * notation, optionally followed by a unit, into the given buffer.
+ */
+template< typename T >
+typename eng_format_detail::if_integer<T, std::size_t>::type
+to_engineering_chars( char * buffer, std::size_t capacity, T value, int digits, eng_exponential_t, char const * unit = "", char const * separator = " " )
+{
+    return to_engineering_chars( buffer, capacity, value, digits, true, unit, separator );
+}
+
+/**
+ * convert a scaled integer exactly to the specified number of digits in
+ * prefixed or exponential notation, optionally followed by a unit, into the
+ * given buffer: eng_decimal( 1234567, -6 ) with 3 digits gives "1.23".
+ */
+inline std::size_t
+to_engineering_chars( char * buffer, std::size_t capacity, eng_decimal_t value, int digits, bool exponential, char const * unit = "", char const * separator = " " )
+{
+    return eng_format_detail::integer_to_chars( buffer, capacity, value.negative, value.magnitude, value.exponent, digits, exponential, unit, separator );
+}
+
+/**
+ * convert a scaled integer exactly to the specified number of digits in SI
+ * (prefix) notation, optionally followed by a unit, into the given buffer.
+ */
+inline std::size_t
+to_engineering_chars( char * buffer, std::size_t capacity, eng_decimal_t value, int digits, eng_prefixed_t, char const * unit = "", char const * separator = " " )
+{
+    return to_engineering_chars( buffer, capacity, value, digits, false, unit, separator );
+}
+
+/**
+ * convert a scaled integer exactly to the specified number of digits in
+ * exponential notation, optionally followed by a unit, into the given buffer.
+ */
+inline std::size_t
+to_engineering_chars( char * buffer, std::size_t capacity, eng_decimal_t value, int digits, eng_exponential_t, char const * unit = "", char const * separator = " " )
+{
+    return to_engineering_chars( buffer, capacity, value, digits, true, unit, separator );
+}
+
+/**
+ * convert an integer, such as a byte count, exactly to the specified number
+ * of digits in IEC binary (prefix) notation, optionally followed by a unit,
+ * into the given buffer. The degree comes from the position of the highest
+ * bit, the digits from shifts; there is no conversion to double.
+ */
+template< typename T >
+typename eng_format_detail::if_integer<T, std::size_t>::type
+to_engineering_chars( char * buffer, std::size_t capacity, T value, int digits, eng_binary_t, char const * unit = "", char const * separator = " " )
+{
+    return eng_format_detail::binary_to_chars( buffer, capacity,
+        eng_format_detail::is_negative_integer( value, std::is_signed<T>() ), eng_format_detail::magnitude_of( value ), digits, unit, separator );
+}
+
+/**
+ * convert a float or a long double to the specified number of digits in
+ * prefixed or exponential notation, optionally followed by a unit, into the
+ * given buffer. A float is not widened, a long double not narrowed: the
+ * digits come from a conversion for its own type.
+ */
+template< typename T >
+typename eng_format_detail::if_float_or_long_double<T, std::size_t>::type
+to_engineering_chars( char * buffer, std::size_t capacity, T value, int digits, bool exponential, char const * unit = "", char const * separator = " " )
+{
+    return eng_format_detail::real_to_chars( buffer, capacity, value, digits, exponential, unit, separator );
+}
+
+/**
+ * convert a float or a long double to the specified number of digits in SI
+ * (prefix) notation, optionally followed by a unit, into the given buffer.
+ */
+template< typename T >
+typename eng_format_detail::if_float_or_long_double<T, std::size_t>::type
+to_engineering_chars( char * buffer, std::size_t capacity, T value, int digits, eng_prefixed_t, char const * unit = "", char const * separator = " " )
+{
+    return to_engineering_chars( buffer, capacity, value, digits, false, unit, separator );
+}
+
+/**
+ * convert a float or a long double to the specified number of digits in
+ * exponential notation, optionally followed by a unit, into the given buffer.
+ */
+template< typename T >
+typename eng_format_detail::if_float_or_long_double<T, std::size_t>::type
+to_engineering_chars( char * buffer, std::size_t capacity, T value, int digits, eng_exponential_t, char const * unit = "", char const * separator = " " )
+{
+    return to_engineering_chars( buffer, capacity, value, digits, true, unit, separator );
+}
+
+/**
+ * convert the output of to_engineering_chars() into a float, double or long
+ * double: from_engineering_chars<float>( text ). The value is rounded once,
+ * to the requested type.
+ */
+template< typename T >
+T from_engineering_chars( char const * text )
+{
+    return eng_format_detail::real_from_chars( text, T() );
+}
+
+/**
+ * convert the output of to_engineering_string() into a float, double or long
+ * double: from_engineering_string<long double>( text ).
+ */
+template< typename T >
+T from_engineering_string( std::string const & text )
+{
+    return from_engineering_chars<T>( text.c_str() );
+}
+
+namespace eng_format_detail
+{
+
+/*
+ * n = 10^result, or -1 if n is not a power of ten.
+ */
+constexpr int log10_exact( std::intmax_t const n )
+{
+    return 1 == n ? 0 : n < 10 || n % 10 ? -1 : log10_exact( n / 10 ) < 0 ? -1 : 1 + log10_exact( n / 10 );
+}
+
+/*
+ * tick period 10^exponent, such as std::nano, 10^-9 s; not decimal
+ * for std::ratio<60>, a minute.
+ */
+template< typename Period >
+struct period_exponent
+{
+    static const bool decimal  = log10_exact( Period::num ) >= 0 && log10_exact( Period::den ) >= 0;
+    static const int  exponent = log10_exact( Period::num ) - log10_exact( Period::den );
+};
+
+template< typename Rep, typename Period >
+std::size_t duration_to_chars( char * buffer, std::size_t capacity, std::chrono::duration<Rep, Period> const value, int digits, bool exponential, char const * unit, char const * separator, std::false_type )
+{
+    return to_engineering_chars( buffer, capacity, std::chrono::duration<double>( value ).count(), digits, exponential, unit, separator );
+}
+
+/*
+ * integer ticks: decimal periods give a scaled integer, whole numbers of
+ * seconds are multiplied out while that is exact; others go through double.
+ */
+template< typename Rep, typename Period >
+std::size_t duration_to_chars( char * buffer, std::size_t capacity, std::chrono::duration<Rep, Period> const value, int digits, bool exponential, char const * unit, char const * separator, std::true_type )
+{
+    const Rep ticks = value.count();
+    const bool negative = is_negative_integer( ticks, std::is_signed<Rep>() );
+    const std::uint64_t magnitude = magnitude_of( ticks );
+
+    if ( period_exponent<Period>::decimal )
+    {
+        return integer_to_chars( buffer, capacity, negative, magnitude, period_exponent<Period>::exponent, digits, exponential, unit, separator );
+    }
+
+    if ( 1 == Period::den && magnitude <= UINT64_MAX / Period::num )
+    {
+        return integer_to_chars( buffer, capacity, negative, magnitude * Period::num, 0, digits, exponential, unit, separator );
+    }
+
+    return duration_to_chars( buffer, capacity, value, digits, exponential, unit, separator, std::false_type() );
+}
+
+} // namespace eng_format_detail
+
+/**
+ * convert a std::chrono::duration to the specified number of digits in
+ * prefixed or exponential notation, followed by a unit, "s" by default,
+ * into the given buffer: std::chrono::nanoseconds( 1230000 ) gives "1.23 ms".
+ * The exponent of the tick period is known at compile time, so that integer
+ * ticks of decimal periods are formatted as a scaled integer, without
+ * floating point.
+ */
+template< typename Rep, typename Period >
+std::size_t
+to_engineering_chars( char * buffer, std::size_t capacity, std::chrono::duration<Rep, Period> value, int digits, bool exponential, char const * unit = "s", char const * separator = " " )
+{
+    return eng_format_detail::duration_to_chars( buffer, capacity, value, digits, exponential, unit, separator, std::is_integral<Rep>() );
+}
+
+/**
+ * convert a std::chrono::duration to the specified number of digits in SI
+ * (prefix) notation, followed by a unit, "s" by default, into the given buffer.
+ */
+template< typename Rep, typename Period >
+std::size_t
+to_engineering_chars( char * buffer, std::size_t capacity, std::chrono::duration<Rep, Period> value, int digits, eng_prefixed_t, char const * unit = "s", char const * separator = " " )
+{
+    return to_engineering_chars( buffer, capacity, value, digits, false, unit, separator );
+}
+
+/**
+ * convert a std::chrono::duration to the specified number of digits in
+ * exponential notation, followed by a unit, "s" by default, into the given buffer.
+ */
+template< typename Rep, typename Period >
+std::size_t
+to_engineering_chars( char * buffer, std::size_t capacity, std::chrono::duration<Rep, Period> value, int digits, eng_exponential_t, char const * unit = "s", char const * separator = " " )
+{
+    return to_engineering_chars( buffer, capacity, value, digits, true, unit, separator );
+}
+
+namespace eng_format_detail
+{
+
+/*
+ * to_engineering_chars() into a string; retry with the length it reports.
+ */
+template< typename V, typename M >
+std::string to_string( V const & value, int const digits, M const mode, std::string const & unit, std::string const & separator )
+{
+    char text[ 64 ];
+
+    const std::size_t length = to_engineering_chars( text, sizeof text, value, digits, mode, unit.c_str(), separator.c_str() );
+
+    if ( length < sizeof text )
+    {
+        return std::string( text, length );
+    }
+
+    std::string result( length + 1, '\0' );
+
+    to_engineering_chars( &result[0], result.size(), value, digits, mode, unit.c_str(), separator.c_str() );
+
+    result.resize( length );
+    return result;
+}
+
+} // namespace eng_format_detail
+
+/**
+ * convert an integer exactly to the specified number of digits in IEC
+ * binary (prefix) notation, optionally followed by a unit: 1536 gives "1.50 Ki".
+ */
+template< typename T >
+typename eng_format_detail::if_integer<T, std::string>::type
+to_engineering_string( T value, int digits, eng_binary_t, std::string unit = "", std::string separator = " " )
+{
+    return eng_format_detail::to_string( value, digits, eng_binary_t(), unit, separator );
+}
+
+/**
+ * convert an integer exactly to the specified number of digits in prefixed or
+ * exponential notation, optionally followed by a unit: 123456789012345678
+ * with 18 digits gives "123.456789012345678 P".
+ */
+template< typename T >
+typename eng_format_detail::if_integer<T, std::string>::type
+to_engineering_string( T value, int digits, bool exponential, std::string unit = "", std::string separator = " " )
+{
+    return eng_format_detail::to_string( value, digits, exponential, unit, separator );
+}
+
+/**
+ * convert an integer exactly to the specified number of digits in SI (prefix)
+ * notation, optionally followed by a unit.
+ */
+template< typename T >
+typename eng_format_detail::if_integer<T, std::string>::type
+to_engineering_string( T value, int digits, eng_prefixed_t, std::string unit = "", std::string separator = " " )
+{
+    return eng_format_detail::to_string( value, digits, false, unit, separator );
+}
+
+/**
+ * convert an integer exactly to the specified number of digits in exponential
+ * notation, optionally followed by a unit.
+ */
+template< typename T >
+typename eng_format_detail::if_integer<T, std::string>::type
+to_engineering_string( T value, int digits, eng_exponential_t, std::string unit = "", std::string separator = " " )
+{
+    return eng_format_detail::to_string( value, digits, true, unit, separator );
+}
+
+/**
+ * convert a float or a long double to the specified number of digits in
+ * prefixed or exponential notation, optionally followed by a unit.
+ */
+template< typename T >
+typename eng_format_detail::if_float_or_long_double<T, std::string>::type
+to_engineering_string( T value, int digits, bool exponential, std::string unit = "", std::string separator = " " )
+{
+    return eng_format_detail::to_string( value, digits, exponential, unit, separator );
+}
+
+/**
+ * convert a float or a long double to the specified number of digits in SI
+ * (prefix) notation, optionally followed by a unit.
+ */
+template< typename T >
+typename eng_format_detail::if_float_or_long_double<T, std::string>::type
+to_engineering_string( T value, int digits, eng_prefixed_t, std::string unit = "", std::string separator = " " )
+{
+    return eng_format_detail::to_string( value, digits, false, unit, separator );
+}
+
+/**
+ * convert a float or a long double to the specified number of digits in
+ * exponential notation, optionally followed by a unit.
+ */
+template< typename T >
+typename eng_format_detail::if_float_or_long_double<T, std::string>::type
+to_engineering_string( T value, int digits, eng_exponential_t, std::string unit = "", std::string separator = " " )
+{
+    return eng_format_detail::to_string( value, digits, true, unit, separator );
+}
+
+/**
+ * convert a scaled integer exactly to the specified number of digits in
+ * prefixed or exponential notation, optionally followed by a unit:
+ * eng_decimal( 1234567, -6 ) with 3 digits and unit "V" gives "1.23 V".
+ */
+inline std::string
+to_engineering_string( eng_decimal_t value, int digits, bool exponential, std::string unit = "", std::string separator = " " )
+{
+    return eng_format_detail::to_string( value, digits, exponential, unit, separator );
+}
+
+/**
+ * convert a scaled integer exactly to the specified number of digits in SI
+ * (prefix) notation, optionally followed by a unit.
+ */
+inline std::string
+to_engineering_string( eng_decimal_t value, int digits, eng_prefixed_t, std::string unit = "", std::string separator = " " )
+{
+    return eng_format_detail::to_string( value, digits, false, unit, separator );
+}
+
+/**
+ * convert a scaled integer exactly to the specified number of digits in
+ * exponential notation, optionally followed by a unit.
+ */
+inline std::string
+to_engineering_string( eng_decimal_t value, int digits, eng_exponential_t, std::string unit = "", std::string separator = " " )
+{
+    return eng_format_detail::to_string( value, digits, true, unit, separator );
+}
+
+/**
+ * convert a std::chrono::duration to the specified number of digits in
+ * prefixed or exponential notation, followed by a unit, "s" by default:
+ * std::chrono::nanoseconds( 456 ) with 3 digits gives "456 ns".
+ */
+template< typename Rep, typename Period >
+std::string
+to_engineering_string( std::chrono::duration<Rep, Period> value, int digits, bool exponential, std::string unit = "s", std::string separator = " " )
+{
+    return eng_format_detail::to_string( value, digits, exponential, unit, separator );
+}
+
+/**
+ * convert a std::chrono::duration to the specified number of digits in SI
+ * (prefix) notation, followed by a unit, "s" by default.
+ */
+template< typename Rep, typename Period >
+std::string
+to_engineering_string( std::chrono::duration<Rep, Period> value, int digits, eng_prefixed_t, std::string unit = "s", std::string separator = " " )
+{
+    return eng_format_detail::to_string( value, digits, false, unit, separator );
+}
+
+/**
+ * convert a std::chrono::duration to the specified number of digits in
+ * exponential notation, followed by a unit, "s" by default.
+ */
+template< typename Rep, typename Period >
+std::string
+to_engineering_string( std::chrono::duration<Rep, Period> value, int digits, eng_exponential_t, std::string unit = "s", std::string separator = " " )
+{
+    return eng_format_detail::to_string( value, digits, true, unit, separator );
+}
+
+namespace eng_format_detail
+{
+
+/*
+ * the unit the string overloads use by default: seconds for a duration.
+ */
+template< typename T >
+struct default_unit { static char const * value() { return ""; } };
+
+template< typename Rep, typename Period >
+struct default_unit< std::chrono::duration<Rep, Period> > { static char const * value() { return "s"; } };
+
+/*
+ * to_engineering_chars() into a string of any allocator; retry with the
+ * length it reports.
+ */
+template< typename String, typename V, typename M >
+void assign_engineering( String & result, V const & value, int const digits, M const mode, char const * const unit, char const * const separator )
+{
+    char text[ 64 ];
+
+    const std::size_t length = to_engineering_chars( text, sizeof text, value, digits, mode, unit, separator );
+
+    if ( length < sizeof text )
+    {
+        result.assign( text, length );
+        return;
+    }
+
+    result.assign( length + 1, '\0' );
+
+    to_engineering_chars( &result[0], result.size(), value, digits, mode, unit, separator );
+
+    result.resize( length );
+}
+
+} // namespace eng_format_detail
+
+/**
+ * convert a value as to_engineering_chars() does, mode bool, eng_prefixed,
+ * eng_exponential or eng_binary, into a string that allocates through the
+ * given allocator only: to_engineering_string( std::allocator_arg, arena,
+ * 1.5e3, 3, eng_prefixed, "Hz" ). The unit and the separator are not
+ * copied into strings.
+ */
+template< typename Allocator, typename T, typename M >
+std::basic_string< char, std::char_traits<char>, Allocator >
+to_engineering_string( std::allocator_arg_t, Allocator const & allocator, T const & value, int digits, M mode, char const * unit = eng_format_detail::default_unit<T>::value(), char const * separator = " " )
+{
+    std::basic_string< char, std::char_traits<char>, Allocator > result( allocator );
+
+    eng_format_detail::assign_engineering( result, value, digits, mode, unit, separator );
+
+    return result;
+}
+
+/**
+ * step a value by the smallest possible increment, mode bool, eng_prefixed
+ * or eng_exponential, into a string that allocates through the given
+ * allocator only.
+ */
+template< typename Allocator, typename M >
+std::basic_string< char, std::char_traits<char>, Allocator >
+step_engineering_string( std::allocator_arg_t, Allocator const & allocator, char const * text, int digits, M mode, bool increment )
+{
+    char result[ 64 ];
+
+    const std::size_t length = step_engineering_chars( result, sizeof result, text, digits, mode, increment );
+
+    return std::basic_string< char, std::char_traits<char>, Allocator >( result, length < sizeof result ? length : sizeof result - 1, allocator );
+}
+
+#if ENG_FORMAT_HAVE_PMR
+
+/**
+ * convert a value as to_engineering_chars() does into a std::pmr::string
+ * that allocates from the given memory resource, such as a per-request
+ * std::pmr::monotonic_buffer_resource (C++17).
+ */
+template< typename T, typename M >
+std::pmr::string
+to_engineering_string( std::pmr::memory_resource * resource, T const & value, int digits, M mode, char const * unit = eng_format_detail::default_unit<T>::value(), char const * separator = " " )
+{
+    return to_engineering_string( std::allocator_arg, std::pmr::polymorphic_allocator<char>( resource ), value, digits, mode, unit, separator );
+}
+
+/**
+ * step a value by the smallest possible increment into a std::pmr::string
+ * that allocates from the given memory resource (C++17).
+ */
+template< typename M >
+std::pmr::string
+step_engineering_string( std::pmr::memory_resource * resource, char const * text, int digits, M mode, bool increment )
+{
+    return step_engineering_string( std::allocator_arg, std::pmr::polymorphic_allocator<char>( resource ), text, digits, mode, increment );
+}
+
+#endif // ENG_FORMAT_HAVE_PMR
+
+/**
+ * \struct eng_key_t
+ * \brief what the text of a value shows, see eng_key().
+ */
+struct eng_key_t
+{
+    bool negative;          ///< sign
+    int degree;             ///< degree of the prefix or exponent
+    int exponent;           ///< exponent of ten of the last digit
+    std::uint64_t mantissa; ///< the digits shown, as an integer
+};
+
+inline bool operator==( eng_key_t const & a, eng_key_t const & b )
+{
+    return a.mantissa == b.mantissa && a.exponent == b.exponent && a.degree == b.degree && a.negative == b.negative;
+}
+
+inline bool operator!=( eng_key_t const & a, eng_key_t const & b )
+{
+    return !( a == b );
+}
+
+/**
+ * the key of the text of a value with the specified number of digits, up to
+ * 19, in either notation, without producing characters: two values give
+ * equal keys exactly when their texts are equal. 1234.5 with 3 digits gives
+ * mantissa 123, exponent 1, degree 1: "1.23 k". NaN and infinity get
+ * exponent and degree the largest int, and mantissa 1 and 0.
+ */
+eng_key_t
+eng_key( double value, int digits );
+
+/**
+ * the key of the text of a value in the specified notation. Prefixed and
+ * exponential text show the same digits and degree, so they have the same
+ * key; binary text shows the digits of the value in units of 1024^degree.
+ */
+inline eng_key_t
+eng_key( double value, int digits, bool /*exponential*/ )
+{
+    return eng_key( value, digits );
+}
+
+inline eng_key_t
+eng_key( double value, int digits, eng_prefixed_t )
+{
+    return eng_key( value, digits );
+}
+
+inline eng_key_t
+eng_key( double value, int digits, eng_exponential_t )
+{
+    return eng_key( value, digits );
+}
+
+eng_key_t
+eng_key( double value, int digits, eng_binary_t );
+
+/**
+ * sort texts in prefixed or exponential notation by value, stably, using
+ * their sort keys: the keys are made and sorted in chunks on the specified
+ * number of threads, 0 for as many as the hardware runs concurrently, then
+ * merged. Small arrays are sorted on the calling thread.
+ */
+void
+eng_sort( char const ** texts, std::size_t count, char const * unit = "", unsigned threads = 0 );
+
+/**
+ * sort strings in prefixed or exponential notation by value, stably, using
+ * their sort keys, on the specified number of threads.
+ */
+void
+eng_sort( std::string * texts, std::size_t count, char const * unit = "", unsigned threads = 0 );
+
+namespace eng_format_detail { struct log_state; }
+
+/**
+ * \class eng_logger
+ * \brief deferred formatting: log() captures a value and the id of its
+ * format in a ring of the calling thread, and a background thread renders
+ * it like to_engineering_chars() and passes the text to the sink.
+ *
+ * Each thread that logs gets its own single-producer ring, created at its
+ * first log() or prepare(), so that log() takes no lock, does not allocate
+ * and does not wait: when the ring is full, the value is dropped and
+ * counted. The texts of one thread reach the sink in the order logged;
+ * those of different threads interleave.
+ */
+class eng_logger
+{
+public:
+    /**
+     * the sink receives the id of the format and the text; it is called on
+     * the background thread only.
+     */
+    typedef std::function< void( int format, char const * text, std::size_t length ) > sink_type;
+
+    /**
+     * start the background thread; each ring holds capacity values, rounded
+     * up to a power of two.
+     */
+    explicit eng_logger( sink_type sink, std::size_t capacity = 4096 );
+
+    /**
+     * render what was logged and stop the background thread.
+     */
+    ~eng_logger();
+
+    eng_logger( eng_logger const & ) = delete;
+    eng_logger & operator=( eng_logger const & ) = delete;
+
+    /**
+     * register a format and return its id, for log().
+     */
+    int add_format( int digits, bool exponential, char const * unit = "", char const * separator = " " );
+
+    /**
+     * create the ring of the calling thread, so that its first log() does
+     * not allocate.
+     */
+    void prepare();
+
+    /**
+     * capture a value to render in the format with the given id; false if
+     * the ring of this thread is full and the value is dropped.
+     */
+    bool log( int format, double value );
+
+    /**
+     * wait until everything logged before the call reached the sink.
+     */
+    void flush();
+
+    /**
+     * the number of values dropped because a ring was full.
+     */
+    unsigned long long dropped() const;
+
+private:
+    std::unique_ptr<eng_format_detail::log_state> state;
+};
+
+#endif // ENG_FORMAT_CPP11
+
+#if ENG_FORMAT_STATS
+
+/**
+ * \struct eng_format_stats
+ * \brief usage counts of all threads, including threads that have ended.
+ * Stepping also counts as a parse and a format.
+ */
+struct eng_format_stats
+{
+    unsigned long long prefixed;            ///< formats in SI (prefix) notation
+    unsigned long long exponential;         ///< formats in exponential notation
+    unsigned long long binary;              ///< formats in IEC binary (prefix) notation
+    unsigned long long exponent_fallback;   ///< SI formats out of the prefix range, written with an exponent
+    unsigned long long nan;                 ///< formats of NaN
+    unsigned long long infinite;            ///< formats of infinity
+    unsigned long long parses;              ///< parses
+    unsigned long long parse_failures;      ///< parses of text that does not start with a number
+    unsigned long long steps;               ///< steps
+};
+
+/**
+ * snapshot of the usage counts; counting continues while it is taken.
+ */
+eng_format_stats
+eng_format_statistics();
+
+#endif // ENG_FORMAT_STATS
+
+/*
+ * Note: the pieces below are shared by the library and by compile-time
+ * formatting, to_engineering_fixed() in eng_format_constexpr.hpp, and are
+ * constexpr where C++20 allows it. Only the conversion to decimal digits is
+ * not shared: at run time std::to_chars() or snprintf() give the digits,
+ * neither of which is constexpr, at compile time exact big-integer
+ * arithmetic does; the tests and the fuzzer compare the two.
+ */
+#if defined( __cpp_constexpr ) && __cpp_constexpr >= 201907L
+# define ENG_FORMAT_CONSTEXPR  constexpr
+#else
+# define ENG_FORMAT_CONSTEXPR  inline
+#endif
+
+/*
+ * Note: micro, "\xb5" in Latin-1, may not work everywhere, so you can define
+ * a glyph yourself, the same for the library and the code that uses it:
+ */
+#ifndef ENG_FORMAT_MICRO_GLYPH
+# define ENG_FORMAT_MICRO_GLYPH "\xb5"
+#endif
+
+namespace eng_format_detail
+{
+
+enum prefix_range { prefix_count = 9 };
+
+/*
+ * significant decimal digits of a value, d1 d2 ... dn, and the exponent
+ * of the first digit: value = d1.d2...dn x 10^exponent.
+ */
+struct decimal
+{
+    bool negative;
+    int  exponent;
+    int  count;
+    char digits[ eng_max_digits ];
+};
+
+ENG_FORMAT_CONSTEXPR int abs_of( int const value )
+{
+    return value < 0 ? -value : value;
+}
+
+/*
+ * degree of an exponent of ten, rounding towards minus infinity: -1 => -1.
+ */
+ENG_FORMAT_CONSTEXPR int degree_of( int const exponent )
+{
+    return exponent >= 0 ? exponent / 3 : -( ( 2 - exponent ) / 3 );
+}
+
+/*
+ * number of digits before the decimal point: 1, 2 or 3.
+ */
+ENG_FORMAT_CONSTEXPR int integral_digits( int const exponent )
+{
+    return exponent - 3 * degree_of( exponent ) + 1;
+}
+
+/*
+ * SI prefix of a degree, for -prefix_count < degree < prefix_count.
+ */
+ENG_FORMAT_CONSTEXPR char const * si_prefix( int const degree )
+{
+    switch ( degree )
+    {
+        case -8: return "y";  case -7: return "z";  case -6: return "a";  case -5: return "f";
+        case -4: return "p";  case -3: return "n";  case -2: return ENG_FORMAT_MICRO_GLYPH;
+        case -1: return "m";  case  1: return "k";  case  2: return "M";  case  3: return "G";
+        case  4: return "T";  case  5: return "P";  case  6: return "E";  case  7: return "Z";
+        case  8: return "Y";
+        default: return "";
+    }
+}
+
+/*
+ * bounded output like snprintf(): write what fits, count everything.
+ */
+class writer
+{
+public:
+    ENG_FORMAT_CONSTEXPR writer( char * buffer, std::size_t capacity )
+    : buffer_( buffer ), capacity_( capacity ), length_( 0 ) {}
+
+    ENG_FORMAT_CONSTEXPR void put( char const chr )
+    {
+        if ( length_ + 1 < capacity_ )
+        {
+            buffer_[ length_ ] = chr;
+        }
+        ++length_;
+    }
+
+    ENG_FORMAT_CONSTEXPR void put( char const * text )
+    {
+        while ( *text )
+        {
+            put( *text++ );
+        }
+    }
+
+    // no snprintf() here: exponents are written without touching the locale.
+    ENG_FORMAT_CONSTEXPR void put( int const value )
+    {
+        char text[ 16 ];
+        char * pos = text + sizeof text;
+        unsigned magnitude = value < 0 ? 0u - static_cast<unsigned>( value ) : static_cast<unsigned>( value );
+
+        *--pos = '\0';
+        do
+        {
+            *--pos = static_cast<char>( '0' + magnitude % 10 );
+            magnitude /= 10;
+        }
+        while ( magnitude );
+
+        if ( value < 0 )
+        {
+            *--pos = '-';
+        }
+        put( pos );
+    }
+
+    ENG_FORMAT_CONSTEXPR std::size_t length() const
+    {
+        return length_;
+    }
+
+    ENG_FORMAT_CONSTEXPR std::size_t finish()
+    {
+        if ( capacity_ > 0 )
+        {
+            buffer_[ length_ < capacity_ ? length_ : capacity_ - 1 ] = '\0';
+        }
+        return length_;
+    }
+
+private:
+    char * const buffer_;
+    std::size_t const capacity_;
+    std::size_t length_;
+};
+
+/*
+ * round to digits significant digits, but keep the digits before the
+ * decimal point: 123 with 2 digits gives 123, not 120. Rounding first
+ * and taking the degree from the result makes 999.96 with 4 digits
+ * give 1.000 k, instead of 1000.0. Digits::convert() gives the correctly
+ * rounded digits.
+ */
+template< typename Digits, typename T >
+ENG_FORMAT_CONSTEXPR void engineering_decimal( T const value, int const digits, decimal & result )
+{
+    Digits::convert( value, digits, result );
+
+    const int integral = integral_digits( result.exponent );
+
+    if ( integral > digits )
+    {
+        decimal more = decimal();
+        Digits::convert( value, integral, more );
+
+        // 99.5 with 2 digits carries to 100, rounding it to 3 digits does not:
+        if ( more.exponent == result.exponent )
+        {
+            result = more;
+        }
+        else while ( result.count < integral )
+        {
+            result.digits[ result.count++ ] = '0';
+        }
+    }
+}
+
+/*
+ * write the sign and digits of a finite value, with the decimal point
+ * after the integral digits of its degree.
+ */
+ENG_FORMAT_CONSTEXPR void write_digits( writer & out, decimal const & dec )
+{
+    const int integral = integral_digits( dec.exponent );
+
+    if ( dec.negative )
+    {
+        out.put( '-' );
+    }
+
+    for ( int i = 0; i < dec.count; ++i )
+    {
+        if ( i == integral )
+        {
+            out.put( '.' );
+        }
+        out.put( dec.digits[i] );
+    }
+}
+
+/*
+ * write the prefix, or the exponent in exponential notation and beyond the
+ * prefixes, and the unit.
+ */
+ENG_FORMAT_CONSTEXPR void write_suffix( writer & out, int const degree, bool exponential, char const * const unit, char const * const separator )
+{
+    if ( ! exponential && abs_of( degree ) < prefix_count )
+    {
+        if ( 0 != degree )
+        {
+            out.put( separator );
+        }
+        out.put( si_prefix( degree ) );
+    }
+    else
+    {
+        exponential = true;
+        out.put( 'e' );
+        out.put( 3 * degree );
+    }
+
+    if ( ( 0 == degree || exponential ) && *unit )
+    {
+        out.put( separator );
+    }
+
+    out.put( unit );
+}
+
+} // namespace eng_format_detail
+
+#ifdef ENG_FORMAT_HEADER_ONLY
+# include "eng_format.cpp"
+#endif
+
 #endif // ENG_FORMAT_H_INCLUDED
@@ -0,0 +1,61 @@
+// Copyright (C) 2013 by Martin Moene
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "eng_format_c.h"
+#include "eng_format.hpp"
+
+namespace
+{
+
+bool is_exponential( int const flags )
+{
+    return 0 != ( flags & ENG_FORMAT_EXPONENTIAL );
+}
+
+char const * separator( int const flags )
+{
+    return flags & ENG_FORMAT_NO_SEPARATOR ? "" : " ";
+}
+
+} // anonymous namespace
+
+size_t
+eng_format( char * const buf, size_t const cap, double const value, int const digits, int const flags, char const * const unit )
+{
+    if ( flags & ENG_FORMAT_BINARY )
+    {
+        return to_engineering_chars( buf, cap, value, digits, eng_binary_t(), unit ? unit : "", separator( flags ) );
+    }
+    return to_engineering_chars( buf, cap, value, digits, is_exponential( flags ), unit ? unit : "", separator( flags ) );
+}
+
+double
+eng_parse( char const * const text )
+{
+    return text ? from_engineering_chars( text ) : 0.0;
+}
+
+size_t
+eng_step( char * const buf, size_t const cap, char const * const text, int const digits, int const flags, int const increment )
+{
+    return step_engineering_chars( buf, cap, text ? text : "", digits, is_exponential( flags ), 0 != increment );
+}
+
+// end of file
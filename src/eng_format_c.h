@@ -0,0 +1,78 @@
+/*
+ * Copyright (C) 2013 by Martin Moene
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef ENG_FORMAT_C_H_INCLUDED
+#define ENG_FORMAT_C_H_INCLUDED
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * C interface: these functions do not allocate and do not throw.
+ *
+ * Functions that produce text write at most cap bytes including the
+ * terminating '\0' and, like snprintf(), return the length of the complete
+ * result: if the return value is cap or more, the text was truncated.
+ */
+
+/**
+ * flags for eng_format() and eng_step().
+ */
+enum
+{
+    ENG_FORMAT_PREFIXED     = 0,    /* SI prefix: "1.23 k" */
+    ENG_FORMAT_EXPONENTIAL  = 1,    /* exponent: "1.23e3" */
+    ENG_FORMAT_NO_SEPARATOR = 2,    /* no space before prefix and unit: "1.23k" */
+    ENG_FORMAT_BINARY       = 4     /* IEC binary prefix, 1024-based: "1.50 Ki" */
+};
+
+/**
+ * convert a double to the specified number of digits in SI (prefix),
+ * exponential or IEC binary (prefix) notation, optionally followed by a
+ * unit (may be NULL).
+ */
+size_t
+eng_format( char * buf, size_t cap, double value, int digits, int flags, char const * unit );
+
+/**
+ * convert the output of eng_format() into a double.
+ */
+double
+eng_parse( char const * text );
+
+/**
+ * step a value by the smallest possible increment (increment != 0) or
+ * decrement (increment == 0). Stepping is decimal only: of the flags, only
+ * ENG_FORMAT_EXPONENTIAL applies; ENG_FORMAT_BINARY and
+ * ENG_FORMAT_NO_SEPARATOR are ignored.
+ */
+size_t
+eng_step( char * buf, size_t cap, char const * text, int digits, int flags, int increment );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ENG_FORMAT_C_H_INCLUDED */
@@ -0,0 +1,308 @@
+// Copyright (C) 2013 by Martin Moene
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef ENG_FORMAT_CONSTEXPR_H_INCLUDED
+#define ENG_FORMAT_CONSTEXPR_H_INCLUDED
+
+/*
+ * Compile-time engineering formatting (C++20):
+ *
+ *   constexpr auto label = to_engineering_fixed( 10e3, 3, eng_prefixed, "Hz" );  // "10.0 kHz"
+ *
+ * The result is a literal type that holds the characters, so a constexpr
+ * variable ends up as static data without startup work or relocations.
+ * Digits are generated exactly with big-integer arithmetic, without
+ * std::ostringstream or the math library. Rounding to the digits of the
+ * degree and writing prefix, exponent and unit are the constexpr pieces of
+ * eng_format.hpp that the library also uses, so that the result matches
+ * to_engineering_string(); only the conversion to decimal digits is of its
+ * own, as std::to_chars() is not constexpr.
+ */
+
+#include "eng_format.hpp"
+
+#include <bit>
+#include <cstdint>
+#include <string_view>
+
+/**
+ * characters and length of a compile-time formatted value.
+ */
+template< std::size_t N >
+struct eng_fixed_string
+{
+    char data[ N ] = {};
+    std::size_t length = 0;
+
+    constexpr char const * c_str() const { return data; }
+    constexpr std::size_t size() const { return length; }
+    constexpr operator std::string_view() const { return std::string_view( data, length ); }
+};
+
+namespace eng_format_detail { namespace ce {
+
+/*
+ * unsigned integer of up to 40 x 32 bits, enough for any double scaled
+ * by a power of ten: 2^1074 and 10^324 * 2^53 both fit.
+ */
+struct big
+{
+    std::uint32_t word[ 40 ] = {};
+    int size = 0;
+
+    constexpr big( std::uint64_t const value = 0 )
+    {
+        for ( std::uint64_t v = value; v; v >>= 32 )
+        {
+            word[ size++ ] = static_cast<std::uint32_t>( v );
+        }
+    }
+
+    constexpr void multiply( std::uint32_t const factor )
+    {
+        std::uint64_t carry = 0;
+        for ( int i = 0; i < size; ++i )
+        {
+            carry += std::uint64_t( word[i] ) * factor;
+            word[i] = static_cast<std::uint32_t>( carry );
+            carry >>= 32;
+        }
+        if ( carry )
+        {
+            word[ size++ ] = static_cast<std::uint32_t>( carry );
+        }
+    }
+
+    constexpr void multiply_pow10( int count )
+    {
+        for ( ; count >= 9; count -= 9 ) multiply( 1000000000u );
+        for ( ; count >  0; count -= 1 ) multiply( 10u );
+    }
+
+    constexpr void shift_left( int const bits )
+    {
+        if ( 0 == size ) return;
+
+        const int words = bits / 32, rest = bits % 32;
+
+        if ( rest )
+        {
+            std::uint32_t carry = 0;
+            for ( int i = 0; i < size; ++i )
+            {
+                const std::uint32_t w = word[i];
+                word[i] = ( w << rest ) | carry;
+                carry = w >> ( 32 - rest );
+            }
+            if ( carry )
+            {
+                word[ size++ ] = carry;
+            }
+        }
+        if ( words )
+        {
+            for ( int i = size - 1; i >= 0; --i ) word[ i + words ] = word[i];
+            for ( int i = 0; i < words; ++i ) word[i] = 0;
+            size += words;
+        }
+    }
+
+    constexpr void subtract( big const & other )
+    {
+        std::int64_t borrow = 0;
+        for ( int i = 0; i < size; ++i )
+        {
+            std::int64_t d = std::int64_t( word[i] ) - ( i < other.size ? other.word[i] : 0 ) - borrow;
+            borrow = d < 0;
+            word[i] = static_cast<std::uint32_t>( d + ( borrow << 32 ) );
+        }
+        while ( size > 0 && 0 == word[ size - 1 ] ) --size;
+    }
+
+    friend constexpr int compare( big const & a, big const & b )
+    {
+        if ( a.size != b.size ) return a.size < b.size ? -1 : +1;
+
+        for ( int i = a.size - 1; i >= 0; --i )
+        {
+            if ( a.word[i] != b.word[i] ) return a.word[i] < b.word[i] ? -1 : +1;
+        }
+        return 0;
+    }
+};
+
+constexpr int bit_length( std::uint64_t value )
+{
+    int length = 0;
+    for ( ; value; value >>= 1 ) ++length;
+    return length;
+}
+
+/*
+ * correctly rounded conversion to count significant digits, ties to even
+ * like std::to_chars() and printf().
+ */
+constexpr void to_decimal( double const value, int const count, decimal & result )
+{
+    const std::uint64_t bits = std::bit_cast<std::uint64_t>( value );
+    const int      biased   = static_cast<int>( bits >> 52 & 0x7ff );
+    const std::uint64_t fraction = bits & ( ( std::uint64_t( 1 ) << 52 ) - 1 );
+
+    result = decimal();
+    result.negative = bits >> 63;
+
+    if ( 0 == biased && 0 == fraction )
+    {
+        for ( ; result.count < count; ++result.count ) result.digits[ result.count ] = '0';
+        return;
+    }
+
+    // value = mantissa * 2^exponent:
+    const std::uint64_t mantissa = biased ? fraction | std::uint64_t( 1 ) << 52 : fraction;
+    const int           exponent = biased ? biased - 1075 : -1074;
+
+    // r / s = value / 10^k, with k at most one too small: floor( n * log10(2) ):
+    const int n = exponent + bit_length( mantissa ) - 1;
+    int k = n >= 0 ? n * 78913 >> 18 : -( ( -n * 78913 + ( 1 << 18 ) - 1 ) >> 18 );
+
+    big r( mantissa ), s( 1 );
+
+    if ( exponent > 0 ) r.shift_left(  exponent );
+    else                s.shift_left( -exponent );
+
+    if ( k > 0 ) s.multiply_pow10(  k );
+    else         r.multiply_pow10( -k );
+
+    big ten_s = s; ten_s.multiply( 10 );
+    if ( compare( r, ten_s ) >= 0 )
+    {
+        s = ten_s;
+        ++k;
+    }
+
+    for ( int i = 0; i < count; ++i )
+    {
+        if ( i > 0 ) r.multiply( 10 );
+
+        char digit = '0';
+        while ( compare( r, s ) >= 0 )
+        {
+            r.subtract( s );
+            ++digit;
+        }
+        result.digits[ result.count++ ] = digit;
+    }
+
+    r.shift_left( 1 );
+    const int half = compare( r, s );
+
+    if ( half > 0 || ( 0 == half && ( result.digits[ count - 1 ] - '0' ) % 2 ) )
+    {
+        int i = count - 1;
+        for ( ; i >= 0 && '9' == result.digits[i]; --i ) result.digits[i] = '0';
+
+        if ( i >= 0 )
+        {
+            ++result.digits[i];
+        }
+        else
+        {
+            result.digits[0] = '1';
+            ++k;
+        }
+    }
+
+    result.exponent = k;
+}
+
+/*
+ * the digits of to_decimal(), for engineering_decimal().
+ */
+struct exact_digits
+{
+    static constexpr void convert( double const value, int const count, decimal & result )
+    {
+        // qualified: in header-only builds lookup also finds the library's to_decimal():
+        ce::to_decimal( value, count, result );
+    }
+};
+
+}} // namespace eng_format_detail::ce
+
+/**
+ * convert a double at compile time to the specified number of digits in SI
+ * (prefix) or exponential notation, optionally followed by a unit.
+ * The result is truncated to N - 1 characters.
+ */
+template< std::size_t N = 32 >
+constexpr eng_fixed_string<N>
+to_engineering_fixed( double const value, int digits, bool exponential, char const * const unit = "", char const * const separator = " " )
+{
+    using namespace eng_format_detail;
+
+    eng_fixed_string<N> result;
+    writer out( result.data, N );
+
+    if ( value != value )
+    {
+        out.put( "NaN" );
+    }
+    else if ( value - value != 0 )
+    {
+        out.put( "INFINITE" );
+    }
+    else
+    {
+        decimal dec = decimal();
+        engineering_decimal<ce::exact_digits>( value, digits < 1 ? 1 : digits > eng_max_digits ? eng_max_digits : digits, dec );
+
+        write_digits( out, dec );
+        write_suffix( out, degree_of( dec.exponent ), exponential, unit, separator );
+    }
+
+    out.finish();
+    result.length = out.length() < N ? out.length() : N - 1;
+
+    return result;
+}
+
+/**
+ * convert a double at compile time to the specified number of digits in SI
+ * (prefix) notation, optionally followed by a unit.
+ */
+template< std::size_t N = 32 >
+constexpr eng_fixed_string<N>
+to_engineering_fixed( double const value, int const digits, eng_prefixed_t, char const * const unit = "", char const * const separator = " " )
+{
+    return to_engineering_fixed<N>( value, digits, false, unit, separator );
+}
+
+/**
+ * convert a double at compile time to the specified number of digits in
+ * exponential notation, optionally followed by a unit.
+ */
+template< std::size_t N = 32 >
+constexpr eng_fixed_string<N>
+to_engineering_fixed( double const value, int const digits, eng_exponential_t, char const * const unit = "", char const * const separator = " " )
+{
+    return to_engineering_fixed<N>( value, digits, true, unit, separator );
+}
+
+#endif // ENG_FORMAT_CONSTEXPR_H_INCLUDED
@@ -0,0 +1,44 @@
+// Copyright (C) 2013 by Martin Moene
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef ENG_FORMAT_REFERENCE_H_INCLUDED
+#define ENG_FORMAT_REFERENCE_H_INCLUDED
+
+#include <string>
+
+/*
+ * The original std::ostringstream-based implementation, frozen for
+ * differential testing.
+ */
+namespace eng_format_reference
+{
+
+std::string
+to_engineering_string( double value, int digits, bool exponential, std::string unit = "", std::string separator = " " );
+
+double
+from_engineering_string( std::string text );
+
+std::string
+step_engineering_string( std::string text, int digits, bool exponential, bool increment );
+
+} // namespace eng_format_reference
+
+#endif // ENG_FORMAT_REFERENCE_H_INCLUDED
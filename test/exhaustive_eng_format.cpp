@@ -0,0 +1,407 @@
+// Copyright (C) 2013 by Martin Moene
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+// Exhaustive verification for float: format every one of the 2^32 float
+// bit patterns with 1 to 9 digits in prefixed and exponential notation,
+// parse the result back, and check:
+//
+// - presentation: 1 to 3 digits before the decimal point, the first one
+//   not zero, max(digits, integral digits) significant digits, and a
+//   prefix or exponent that is a multiple of 3,
+// - rounding: the displayed value is within half a unit in the last
+//   displayed place of the float, or, when rounding to the requested
+//   digits carries into an extra integral digit (95 -> "100"), within
+//   half a unit in the last requested place with zeros padded; ties are
+//   verified with the exact big-integer kernel of to_engineering_fixed(),
+// - parsing: from_engineering_chars<float>() rounds the displayed value
+//   once, as strtof() does, and 9 digits give the float back.
+//
+// Floats take the float overloads, they are not widened to double.
+//
+//   exhaustive_eng_format [first [last [threads]]]
+//
+// first and last are bit patterns, e.g. 0x3f800000; the work is spread
+// over all cores and progress is reported without locking.
+
+#include "eng_format.hpp"
+#include "eng_format_constexpr.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifndef ENG_FORMAT_MICRO_GLYPH
+# define ENG_FORMAT_MICRO_GLYPH "\xb5"
+#endif
+
+namespace {
+
+typedef std::uint64_t counter;
+
+const counter chunk_size = 1 << 16;
+
+std::atomic<counter> chunks_done;
+std::atomic<counter> checks_done;
+std::atomic<counter> ties_checked;
+std::atomic<counter> failures;
+std::atomic<counter> first_failure( ~counter( 0 ) );
+
+std::mutex  report_mutex;
+std::string first_report;
+
+/*
+ * the number shown: significant digits as an integer and the power of ten
+ * of the last digit: value = mantissa x 10^last.
+ */
+struct shown
+{
+    bool negative;
+    int  integral;
+    int  count;
+    char digits[ 64 ];
+    int  last;
+};
+
+int prefix_exponent( char const * text )
+{
+    static char const * const prefixes[] = { "y", "z", "a", "f", "p", "n", ENG_FORMAT_MICRO_GLYPH, "m", "", "k", "M", "G", "T", "P", "E", "Z", "Y" };
+
+    for ( int i = 0; i < 17; ++i )
+    {
+        if ( 0 == std::strcmp( text, prefixes[i] ) )
+        {
+            return 3 * ( i - 8 );
+        }
+    }
+    return 9999;
+}
+
+char const * parse_shown( char const * text, bool const exponential, shown & result )
+{
+    char const * pos = text;
+
+    result.negative = '-' == *pos;
+    pos += result.negative;
+
+    result.integral = 0;
+    result.count    = 0;
+
+    for ( ; '0' <= *pos && *pos <= '9'; ++pos )
+    {
+        result.digits[ result.count++ ] = *pos;
+        ++result.integral;
+    }
+
+    if ( '.' == *pos )
+    {
+        for ( ++pos; '0' <= *pos && *pos <= '9'; ++pos )
+        {
+            result.digits[ result.count++ ] = *pos;
+        }
+        if ( result.count == result.integral )
+        {
+            return "decimal point without decimals";
+        }
+    }
+    result.digits[ result.count ] = '\0';
+
+    int power = 0;
+
+    if ( 'e' == *pos )
+    {
+        char * end;
+        power = static_cast<int>( std::strtol( pos + 1, &end, 10 ) );
+        if ( *end || end == pos + 1 ) return "malformed exponent";
+    }
+    else if ( exponential )
+    {
+        return "missing exponent";
+    }
+    else
+    {
+        if ( ' ' == *pos ) ++pos;
+        power = prefix_exponent( pos );
+        if ( 9999 == power ) return "unknown prefix";
+    }
+
+    if ( power % 3 )
+    {
+        return "exponent is not a multiple of 3";
+    }
+
+    result.last = power - ( result.count - result.integral );
+    return NULL;
+}
+
+/*
+ * digits beyond the requested ones are zeros padded after a carry.
+ */
+bool is_padded( shown const & number, int const digits )
+{
+    for ( int i = digits; i < number.count; ++i )
+    {
+        if ( '0' != number.digits[i] ) return false;
+    }
+    return '1' == number.digits[0];
+}
+
+/*
+ * check one float, digits and notation; returns a reason on failure.
+ */
+char const * check( float const value, int const digits, bool const exponential, char * const text, std::size_t const capacity )
+{
+    const std::size_t length = to_engineering_chars( text, capacity, value, digits, exponential );
+
+    if ( length >= capacity )
+    {
+        return "truncated";
+    }
+
+    const double exact  = value;
+    const float  parsed = from_engineering_chars<float>( text );
+
+    if ( std::isnan( exact ) )
+    {
+        return 0 == std::strcmp( text, "NaN" ) && std::isnan( parsed ) ? NULL : "NaN not recognised";
+    }
+    if ( std::isinf( exact ) )
+    {
+        return 0 == std::strcmp( text, "INFINITE" ) && std::isinf( parsed ) ? NULL : "infinity not recognised";
+    }
+
+    shown number;
+
+    if ( char const * reason = parse_shown( text, exponential, number ) )
+    {
+        return reason;
+    }
+
+    if ( number.negative != std::signbit( exact ) )
+    {
+        return "wrong sign";
+    }
+    if ( number.integral < 1 || number.integral > 3 )
+    {
+        return "wrong number of integral digits";
+    }
+    if ( 0 != exact && '0' == number.digits[0] )
+    {
+        return "leading zero, wrong degree";
+    }
+    if ( number.count != (std::max)( digits, number.integral ) )
+    {
+        return "wrong number of significant digits";
+    }
+
+    // displayed value, correctly rounded to double:
+    char decimal[ 96 ];
+    std::snprintf( decimal, sizeof decimal, "%se%d", number.digits, number.last );
+
+    const double displayed = std::strtod( decimal, NULL );
+    const double tolerance = 4 * std::fabs( exact ) * std::numeric_limits<double>::epsilon();
+    const double error     = std::fabs( displayed - std::fabs( exact ) );
+
+    double half_place = 0.5 * std::pow( 10.0, number.last );
+
+    if ( error > half_place + tolerance && number.count > digits && is_padded( number, digits ) )
+    {
+        half_place *= std::pow( 10.0, number.count - digits );
+    }
+
+    if ( error > half_place + tolerance )
+    {
+        return "not correctly rounded";
+    }
+
+    if ( error > half_place - tolerance )
+    {
+        // (near) tie: compare with the exact kernel:
+        ++ties_checked;
+
+        if ( std::string_view( to_engineering_fixed<64>( value, digits, exponential ) ) != std::string_view( text, length ) )
+        {
+            return "tie not rounded to even";
+        }
+    }
+
+    if ( std::fabs( parsed ) != std::strtof( decimal, NULL ) )
+    {
+        return "parsed value not correctly rounded to float";
+    }
+
+    if ( 9 == digits && parsed != value )
+    {
+        return "no round trip with 9 digits";
+    }
+
+    return NULL;
+}
+
+void report( std::uint32_t const bits, int const digits, bool const exponential, char const * const text, char const * const reason )
+{
+    ++failures;
+
+    std::lock_guard<std::mutex> lock( report_mutex );
+
+    if ( bits < first_failure )
+    {
+        float value;
+        std::memcpy( &value, &bits, sizeof value );
+
+        char line[ 256 ];
+        std::snprintf( line, sizeof line, "0x%08x (%.9g), %d digits, %s: \"%s\": %s",
+            static_cast<unsigned>( bits ), value, digits, exponential ? "exponential" : "prefixed", text, reason );
+
+        first_failure = bits;
+        first_report  = line;
+    }
+}
+
+void worker( counter const first, counter const last, std::atomic<counter> & next_chunk )
+{
+    char text[ 64 ];
+
+    for ( ;; )
+    {
+        const counter begin = first + chunk_size * next_chunk++;
+
+        if ( begin > last )
+        {
+            return;
+        }
+
+        const counter end = (std::min)( last + 1, begin + chunk_size );
+        counter checks = 0;
+
+        for ( counter bits = begin; bits < end; ++bits )
+        {
+            const std::uint32_t pattern = static_cast<std::uint32_t>( bits );
+
+            float value;
+            std::memcpy( &value, &pattern, sizeof value );
+
+            for ( int digits = 1; digits <= 9; ++digits )
+            {
+                for ( int exponential = 0; exponential < 2; ++exponential )
+                {
+                    if ( char const * reason = check( value, digits, exponential, text, sizeof text ) )
+                    {
+                        report( pattern, digits, exponential, text, reason );
+                    }
+                    ++checks;
+                }
+            }
+        }
+
+        checks_done.fetch_add( checks, std::memory_order_relaxed );
+        chunks_done.fetch_add( 1, std::memory_order_relaxed );
+    }
+}
+
+// a whole number without sign, decimal or with prefix 0x hexadecimal; false
+// for "--help" and the like, instead of reading it as 0:
+bool parse_number( char const * const text, counter & value )
+{
+    char * end = NULL;
+    errno = 0;
+    value = std::strtoull( text, &end, 0 );
+
+    return std::isdigit( static_cast<unsigned char>( *text ) ) && '\0' == *end && 0 == errno;
+}
+
+} // anonymous namespace
+
+int main( int argc, char * argv[] )
+{
+    counter first   = 0;
+    counter last    = 0xffffffffull;
+    counter threads = (std::max)( 1u, std::thread::hardware_concurrency() );
+
+    if ( argc > 4
+        || ( argc > 1 && ! parse_number( argv[1], first ) )
+        || ( argc > 2 && ! parse_number( argv[2], last ) )
+        || ( argc > 3 && ! parse_number( argv[3], threads ) )
+        || first > last || last > 0xffffffffull || threads < 1 )
+    {
+        std::fprintf( stderr, "usage: exhaustive_eng_format [first [last [threads]]], 0 <= first <= last <= 0xffffffff, 1 <= threads\n" );
+        return EXIT_FAILURE;
+    }
+
+    std::printf( "exhaustive_eng_format: float patterns 0x%08llx..0x%08llx on %llu threads\n",
+        static_cast<unsigned long long>( first ), static_cast<unsigned long long>( last ), static_cast<unsigned long long>( threads ) );
+
+    typedef std::chrono::steady_clock clock;
+    const clock::time_point start = clock::now();
+
+    std::atomic<counter> next_chunk( 0 );
+    std::vector<std::thread> pool;
+
+    for ( counter i = 0; i < threads; ++i )
+    {
+        pool.push_back( std::thread( worker, first, last, std::ref( next_chunk ) ) );
+    }
+
+    const counter total_chunks = ( last - first ) / chunk_size + 1;
+
+    while ( chunks_done.load( std::memory_order_relaxed ) < total_chunks )
+    {
+        std::this_thread::sleep_for( std::chrono::milliseconds( 500 ) );
+
+        const double seconds = std::chrono::duration<double>( clock::now() - start ).count();
+        const counter done   = chunks_done.load( std::memory_order_relaxed );
+
+        std::fprintf( stderr, "\r%5.1f%%, %.0f checks/s, %llu failures, eta %.0f s ",
+            100.0 * done / total_chunks, checks_done.load( std::memory_order_relaxed ) / seconds,
+            static_cast<unsigned long long>( failures.load() ), done ? seconds * ( total_chunks - done ) / done : 0.0 );
+    }
+
+    for ( std::size_t i = 0; i < pool.size(); ++i )
+    {
+        pool[i].join();
+    }
+
+    const double seconds = std::chrono::duration<double>( clock::now() - start ).count();
+
+    std::fprintf( stderr, "\n" );
+    std::printf( "%llu checks in %.1f s: %.0f checks/s, %llu ties verified exactly, %llu failures\n",
+        static_cast<unsigned long long>( checks_done.load() ), seconds, checks_done.load() / seconds,
+        static_cast<unsigned long long>( ties_checked.load() ), static_cast<unsigned long long>( failures.load() ) );
+
+    if ( failures )
+    {
+        std::printf( "first failure: %s\n", first_report.c_str() );
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
+
+// g++ -O2 -std=c++20 -pthread -I../src -o exhaustive_eng_format exhaustive_eng_format.cpp ../src/eng_format.cpp && exhaustive_eng_format
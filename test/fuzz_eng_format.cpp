@@ -0,0 +1,658 @@
+// Copyright (C) 2013 by Martin Moene
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+// Differential fuzzing: compare the current implementation with the frozen
+// std::ostringstream-based reference on random and adversarial inputs:
+//
+//   fuzz_eng_format [iterations [threads [seed]]]
+//
+// Formatting may diverge from the reference only in documented ways, where
+// the reference is wrong; each divergence is classified and counted. With
+// C++20, formatting must also be byte-identical to the independent
+// big-integer kernel of to_engineering_fixed(). Parsing must give the same
+// double as the reference, bit for bit. The first unexplained difference
+// stops the run and is reported.
+
+#include "eng_format.hpp"
+#include "eng_format_reference.hpp"
+
+#if __cplusplus >= 202002L
+# include "eng_format_constexpr.hpp"
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifndef ENG_FORMAT_MICRO_GLYPH
+# define ENG_FORMAT_MICRO_GLYPH "\xb5"
+#endif
+
+namespace {
+
+typedef std::mt19937_64 generator;
+typedef unsigned long long counter;
+
+const counter block_size = 4096;
+
+/*
+ * how formatted output may differ from the reference.
+ */
+enum divergence
+{
+    identical,
+    carry,              // rounding carries into the next power of ten: "1000.000e-27" => "1.00000e-24"
+    scaled_rounding,    // reference rounds value * 1000^-degree, an inexact product, not the value
+    negative_precision, // reference prints 6 decimals when digits < integral digits: "123.000000"
+    scale_overflow,     // reference overflows 1000^-degree for tiny values: "infe-309"
+    mismatch,
+    divergence_count
+};
+
+char const * const divergence_names[ divergence_count ] =
+{
+    "identical",
+    "rounding carries into next power of ten",
+    "reference rounds inexact scaled value",
+    "reference uses negative precision",
+    "reference overflows scale factor",
+    "unexplained mismatch",
+};
+
+std::atomic<counter> divergences[ divergence_count ];
+std::atomic<counter> blocks_done;
+std::atomic<counter> parses_done;
+std::atomic<counter> binary_parses;
+std::atomic<bool>    stop;
+
+std::mutex  first_mutex;
+counter     first_index = ~counter( 0 );
+std::string first_report;
+
+void report_mismatch( counter const index, std::string const & report )
+{
+    std::lock_guard<std::mutex> lock( first_mutex );
+
+    if ( index < first_index )
+    {
+        first_index  = index;
+        first_report = report;
+    }
+    stop = true;
+}
+
+std::string escape( std::string const & text )
+{
+    std::string result;
+    for ( std::size_t i = 0; i < text.size(); ++i )
+    {
+        const unsigned char chr = text[i];
+        char hex[ 8 ];
+
+        if ( chr < 0x20 || chr >= 0x7f || '\\' == chr )
+        {
+            std::snprintf( hex, sizeof hex, "\\x%02x", chr );
+            result += hex;
+        }
+        else
+        {
+            result += static_cast<char>( chr );
+        }
+    }
+    return "\"" + result + "\"";
+}
+
+std::string describe( double const value )
+{
+    char text[ 64 ];
+    std::snprintf( text, sizeof text, "%.17g (%a)", value, value );
+    return text;
+}
+
+//
+// Values:
+//
+
+double from_bits( std::uint64_t const bits )
+{
+    double value;
+    std::memcpy( &value, &bits, sizeof value );
+    return value;
+}
+
+double neighbour( generator & gen, double const value )
+{
+    switch ( gen() % 3 )
+    {
+    case 0:  return std::nextafter( value, +HUGE_VAL );
+    case 1:  return std::nextafter( value, -HUGE_VAL );
+    default: return value;
+    }
+}
+
+double with_sign( generator & gen, double const value )
+{
+    return gen() % 2 ? value : -value;
+}
+
+double random_bits( generator & gen )
+{
+    return from_bits( gen() );
+}
+
+double power_of_ten( generator & gen )
+{
+    char text[ 16 ];
+    std::snprintf( text, sizeof text, "1e%d", static_cast<int>( gen() % 633 ) - 324 );
+
+    return with_sign( gen, neighbour( gen, std::strtod( text, NULL ) ) );
+}
+
+// d.dd...d5 x 10^e, half-way between two roundings:
+double rounding_boundary( generator & gen )
+{
+    std::string text( 1, static_cast<char>( '1' + gen() % 9 ) );
+    text += '.';
+
+    for ( int i = static_cast<int>( gen() % 17 ); i > 0; --i )
+    {
+        text += static_cast<char>( '0' + gen() % 10 );
+    }
+
+    char exponent[ 16 ];
+    std::snprintf( exponent, sizeof exponent, "5e%d", static_cast<int>( gen() % 600 ) - 300 );
+
+    return with_sign( gen, neighbour( gen, std::strtod( ( text + exponent ).c_str(), NULL ) ) );
+}
+
+// 999.5, 99.95, 9.995, 999.95 ... x 10^3k, where the degree may change:
+double degree_boundary( generator & gen )
+{
+    std::string text( 1 + gen() % 6, '9' );
+    text += '5';
+    const std::size_t point = 1 + gen() % (std::min)( std::size_t( 3 ), text.size() - 1 );
+    text = text.substr( 0, point ) + '.' + text.substr( point );
+
+    char exponent[ 16 ];
+    std::snprintf( exponent, sizeof exponent, "e%d", 3 * ( static_cast<int>( gen() % 200 ) - 100 ) );
+
+    return with_sign( gen, neighbour( gen, std::strtod( ( text + exponent ).c_str(), NULL ) ) );
+}
+
+double subnormal( generator & gen )
+{
+    return from_bits( gen() & 0x800fffffffffffffull );
+}
+
+double random_value( generator & gen )
+{
+    switch ( gen() % 5 )
+    {
+    case 0:  return random_bits( gen );
+    case 1:  return power_of_ten( gen );
+    case 2:  return rounding_boundary( gen );
+    case 3:  return degree_boundary( gen );
+    default: return subnormal( gen );
+    }
+}
+
+//
+// Texts:
+//
+
+char const * const units[] = { "", "V", "Hz", "Pa", "s" };
+char const * const separators[] = { " ", "" };
+
+std::string valid_text( generator & gen )
+{
+    return to_engineering_string( random_value( gen ), 1 + gen() % 17, 0 != gen() % 2, units[ gen() % 5 ], separators[ gen() % 2 ] );
+}
+
+std::string junk_text( generator & gen )
+{
+    static char const * const pieces[] =
+    {
+        "0", "1", "5", "9", ".", "-", "+", "e", "E", " ", "\t", "k", "M", "G", "Y",
+        "m", "u", "n", "y", "\xb5", "\xce\xbc", "x", "inf", "nan", "0x", "1e400", "e-",
+    };
+
+    std::string text;
+    for ( int i = static_cast<int>( gen() % 12 ); i > 0; --i )
+    {
+        text += pieces[ gen() % ( sizeof pieces / sizeof pieces[0] ) ];
+    }
+    return text;
+}
+
+std::string micro_text( generator & gen )
+{
+    static char const * const micros[] = { "\xce\xbc", "\xb5", "u", ENG_FORMAT_MICRO_GLYPH };
+
+    char number[ 32 ];
+    std::snprintf( number, sizeof number, "%.*f", static_cast<int>( gen() % 4 ), std::uniform_real_distribution<double>( 1, 999 )( gen ) );
+
+    return std::string( number ) + separators[ gen() % 2 ] + micros[ gen() % 4 ] + units[ gen() % 5 ];
+}
+
+std::string random_text( generator & gen )
+{
+    switch ( gen() % 3 )
+    {
+    case 0:  return valid_text( gen );
+    case 1:  return junk_text( gen );
+    default: return micro_text( gen );
+    }
+}
+
+//
+// Classification of formatting differences:
+//
+
+/*
+ * decimal value of a formatted number: significant digits without leading
+ * and trailing zeros, the exponent of the first digit, and the number of
+ * significant digits shown.
+ */
+struct decimal_value
+{
+    bool negative;
+    std::string digits;
+    int exponent;
+    int shown;
+};
+
+int prefix_exponent( std::string const & text )
+{
+    static char const * const prefixes[] = { "y", "z", "a", "f", "p", "n", ENG_FORMAT_MICRO_GLYPH, "m", "", "k", "M", "G", "T", "P", "E", "Z", "Y" };
+
+    for ( int i = 0; i < 17; ++i )
+    {
+        if ( text == prefixes[i] )
+        {
+            return 3 * ( i - 8 );
+        }
+    }
+    return 9999;
+}
+
+bool parse_decimal( std::string text, std::string const & unit, std::string const & separator, decimal_value & result )
+{
+    if ( ! unit.empty() )
+    {
+        if ( text.size() < unit.size() || 0 != text.compare( text.size() - unit.size(), unit.size(), unit ) )
+        {
+            return false;
+        }
+        text.erase( text.size() - unit.size() );
+    }
+
+    std::size_t pos = 0;
+    result.negative = pos < text.size() && '-' == text[pos];
+    pos += result.negative;
+
+    std::string raw;
+    int integral = -1;
+
+    for ( ; pos < text.size() && ( std::isdigit( static_cast<unsigned char>( text[pos] ) ) || '.' == text[pos] ); ++pos )
+    {
+        if ( '.' == text[pos] ) integral = static_cast<int>( raw.size() );
+        else                    raw += text[pos];
+    }
+
+    if ( raw.empty() )
+    {
+        return false;
+    }
+    if ( integral < 0 )
+    {
+        integral = static_cast<int>( raw.size() );
+    }
+
+    std::string factor = text.substr( pos );
+
+    if ( ! separator.empty() && 0 == factor.find( separator ) )
+    {
+        factor.erase( 0, separator.size() );
+    }
+    if ( ! separator.empty() && factor.size() >= separator.size() && 0 == factor.compare( factor.size() - separator.size(), separator.size(), separator ) )
+    {
+        factor.erase( factor.size() - separator.size() );
+    }
+
+    const int power = ! factor.empty() && 'e' == factor[0] ? std::atoi( factor.c_str() + 1 ) : prefix_exponent( factor );
+
+    if ( 9999 == power )
+    {
+        return false;
+    }
+
+    const std::size_t first = raw.find_first_not_of( '0' );
+
+    if ( std::string::npos == first )
+    {
+        result.digits.clear();
+        result.exponent = 0;
+        result.shown = static_cast<int>( raw.size() );
+        return true;
+    }
+
+    result.digits   = raw.substr( first, raw.find_last_not_of( '0' ) + 1 - first );
+    result.exponent = integral - 1 - static_cast<int>( first ) + power;
+    result.shown    = static_cast<int>( raw.size() - first );
+    return true;
+}
+
+long double to_long_double( decimal_value const & value )
+{
+    return ( value.negative ? -1 : +1 ) * std::strtold( ( "0." + value.digits ).c_str(), NULL ) * std::pow( 10.0L, value.exponent + 1 );
+}
+
+divergence classify( std::string const & reference, std::string const & actual, int const digits, std::string const & unit, std::string const & separator )
+{
+    if ( reference == actual )
+    {
+        return identical;
+    }
+
+    if ( std::string::npos != reference.find( "inf" ) || std::string::npos != reference.find( "nan" ) )
+    {
+        return scale_overflow;
+    }
+
+    const std::size_t point = reference.find( '.' );
+
+    if ( digits < 3 && std::string::npos != point && reference.find_first_not_of( "0123456789", point + 1 ) - point - 1 == 6 )
+    {
+        return negative_precision;
+    }
+
+    decimal_value ref, act;
+
+    if ( ! parse_decimal( reference, unit, separator, ref ) || ! parse_decimal( actual, unit, separator, act ) )
+    {
+        return mismatch;
+    }
+
+    if ( ref.negative == act.negative && ref.digits == act.digits && ref.exponent == act.exponent )
+    {
+        return carry;
+    }
+
+    // reference keeps all integral digits: 97.8 with 1 digit gives 98, not 100:
+    if ( ref.negative == act.negative && "1" == act.digits && ref.exponent == act.exponent - 1 )
+    {
+        return carry;
+    }
+
+    // the scaled value is off by up to half an ulp of a double, which the
+    // reference may round either way, and which shows beyond 16 digits:
+    const long double exact      = to_long_double( act );
+    const long double difference = std::fabs( to_long_double( ref ) - exact );
+    const long double last_place = std::pow( 10.0L, act.exponent - act.shown + 1 );
+
+    if ( difference <= last_place + std::fabs( exact ) * std::numeric_limits<double>::epsilon() )
+    {
+        return scaled_rounding;
+    }
+
+    return mismatch;
+}
+
+bool same_double( double const a, double const b )
+{
+    return ( std::isnan( a ) && std::isnan( b ) ) || 0 == std::memcmp( &a, &b, sizeof a );
+}
+
+//
+// Checks:
+//
+
+bool check_format( counter const index, generator & gen )
+{
+    const double value     = random_value( gen );
+    const int    digits    = 1 + static_cast<int>( gen() % 20 );
+    const bool   exponent  = 0 != gen() % 2;
+    const std::string unit = units[ gen() % 5 ];
+    const std::string sep  = separators[ gen() % 2 ];
+
+    const std::string actual    = to_engineering_string( value, digits, exponent, unit, sep );
+    const std::string reference = eng_format_reference::to_engineering_string( value, digits, exponent, unit, sep );
+
+    const divergence kind = classify( reference, actual, digits, unit, sep );
+
+    ++divergences[ kind ];
+
+    std::string expected = reference;
+    bool ok = mismatch != kind;
+
+#if __cplusplus >= 202002L
+    const std::string exact = to_engineering_fixed<128>( value, digits, exponent, unit.c_str(), sep.c_str() ).c_str();
+
+    if ( exact != actual )
+    {
+        expected = exact + " (big-integer kernel)";
+        ok = false;
+    }
+#endif
+
+    if ( ! ok )
+    {
+        report_mismatch( index,
+            "to_engineering_string( " + describe( value ) + ", " + std::to_string( digits ) + ", " + ( exponent ? "true" : "false" ) + ", " + escape( unit ) + ", " + escape( sep ) + " ):\n" +
+            "  expected: " + escape( expected ) + "\n" +
+            "  actual:   " + escape( actual ) );
+    }
+    return ok;
+}
+
+// the reference has no IEC binary prefixes: "1.5 Ki" is 1536, not 1.5e3:
+int binary_degree( char const * text )
+{
+    static char const letters[] = "KMGTPEZY";
+
+    while ( std::isspace( static_cast<unsigned char>( *text ) ) )
+    {
+        ++text;
+    }
+
+    char const * const letter = *text ? std::strchr( letters, *text ) : NULL;
+
+    return letter && 'i' == text[1] ? static_cast<int>( letter - letters ) + 1 : 0;
+}
+
+bool check_parse( counter const index, generator & gen )
+{
+    const std::string text = random_text( gen );
+
+    const double actual = from_engineering_chars( text.c_str() );
+    double reference    = eng_format_reference::from_engineering_string( text );
+
+    char * tail;
+    const double magnitude = std::strtod( text.c_str(), &tail );
+
+    if ( const int degree = binary_degree( tail ) )
+    {
+        reference = std::ldexp( magnitude, 10 * degree );
+        ++binary_parses;
+    }
+
+    ++parses_done;
+
+    if ( ! same_double( actual, reference ) )
+    {
+        report_mismatch( index,
+            "from_engineering_chars( " + escape( text ) + " ):\n" +
+            "  expected: " + describe( reference ) + "\n" +
+            "  actual:   " + describe( actual ) );
+        return false;
+    }
+    return true;
+}
+
+bool check_step( counter const index, generator & gen )
+{
+    const std::string text = valid_text( gen );
+    const int  digits      = 1 + static_cast<int>( gen() % 12 );
+    const bool exponent    = 0 != gen() % 2;
+    const bool increment   = 0 != gen() % 2;
+
+    const std::string actual    = step_engineering_string( text, digits, exponent, increment );
+    const std::string reference = eng_format_reference::step_engineering_string( text, digits, exponent, increment );
+
+    const divergence kind = classify( reference, actual, digits < 3 ? 3 : digits, "", " " );
+
+    ++divergences[ kind ];
+
+    if ( mismatch == kind )
+    {
+        report_mismatch( index,
+            "step_engineering_string( " + escape( text ) + ", " + std::to_string( digits ) + ", " + ( exponent ? "true" : "false" ) + ", " + ( increment ? "true" : "false" ) + " ):\n" +
+            "  expected: " + escape( reference ) + "\n" +
+            "  actual:   " + escape( actual ) );
+        return false;
+    }
+    return true;
+}
+
+// a whole decimal number without sign, as the arguments must be; false for
+// "--help" and the like, instead of reading it as 0:
+bool parse_number( char const * const text, counter & value )
+{
+    char * end = NULL;
+    errno = 0;
+    value = std::strtoull( text, &end, 10 );
+
+    return std::isdigit( static_cast<unsigned char>( *text ) ) && '\0' == *end && 0 == errno;
+}
+
+void worker( counter const iterations, counter const seed, std::atomic<counter> & next_block )
+{
+    for ( ;; )
+    {
+        const counter block = next_block++;
+        const counter start = block * block_size;
+
+        if ( stop || start >= iterations )
+        {
+            return;
+        }
+
+        generator gen( seed * 0x9e3779b97f4a7c15ull + block );
+
+        for ( counter i = start; i < start + block_size && i < iterations; ++i )
+        {
+            if ( ! check_format( i, gen ) || ! check_parse( i, gen ) || ! check_step( i, gen ) )
+            {
+                return;
+            }
+        }
+        ++blocks_done;
+    }
+}
+
+} // anonymous namespace
+
+int main( int argc, char * argv[] )
+{
+    counter iterations = 1000000;
+    counter threads    = (std::max)( 1u, std::thread::hardware_concurrency() );
+    counter seed       = 1;
+
+    if ( argc > 4
+        || ( argc > 1 && ! parse_number( argv[1], iterations ) )
+        || ( argc > 2 && ! parse_number( argv[2], threads ) )
+        || ( argc > 3 && ! parse_number( argv[3], seed ) )
+        || threads < 1 )
+    {
+        std::fprintf( stderr, "usage: fuzz_eng_format [iterations [threads [seed]]], 1 <= threads\n" );
+        return EXIT_FAILURE;
+    }
+
+    std::printf( "fuzz_eng_format: %llu iterations on %llu threads, seed %llu%s\n", iterations, threads, seed,
+#if __cplusplus >= 202002L
+        ", with big-integer kernel"
+#else
+        ""
+#endif
+    );
+
+    typedef std::chrono::steady_clock clock;
+    const clock::time_point start = clock::now();
+
+    std::atomic<counter> next_block( 0 );
+    std::vector<std::thread> pool;
+
+    for ( counter i = 0; i < threads; ++i )
+    {
+        pool.push_back( std::thread( worker, iterations, seed, std::ref( next_block ) ) );
+    }
+
+    const counter total_blocks = ( iterations + block_size - 1 ) / block_size;
+
+    while ( ! stop && blocks_done < total_blocks )
+    {
+        std::this_thread::sleep_for( std::chrono::milliseconds( 100 ) );
+
+        const double seconds = std::chrono::duration<double>( clock::now() - start ).count();
+        const counter done = (std::min)( iterations, blocks_done * block_size );
+
+        std::fprintf( stderr, "\r%llu / %llu iterations, %.0f iterations/s ", done, iterations, done / seconds );
+    }
+
+    for ( std::size_t i = 0; i < pool.size(); ++i )
+    {
+        pool[i].join();
+    }
+
+    const double seconds = std::chrono::duration<double>( clock::now() - start ).count();
+    const counter checks = divergences[ identical ] + divergences[ carry ] + divergences[ scaled_rounding ] +
+                           divergences[ negative_precision ] + divergences[ scale_overflow ] + divergences[ mismatch ] + parses_done;
+
+    std::fprintf( stderr, "\n" );
+    std::printf( "%llu checks in %.1f s: %.0f checks/s\n", checks, seconds, checks / seconds );
+
+    for ( int i = 0; i < divergence_count; ++i )
+    {
+        std::printf( "  %-42s %llu\n", divergence_names[i], static_cast<counter>( divergences[i] ) );
+    }
+    std::printf( "  %-42s %llu\n", "parses, bit-identical", static_cast<counter>( parses_done ) );
+    std::printf( "  %-42s %llu\n", "of which with binary prefix", static_cast<counter>( binary_parses ) );
+
+    if ( stop )
+    {
+        std::printf( "first mismatch, iteration %llu:\n%s\n", first_index, first_report.c_str() );
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
+
+// g++ -O2 -std=c++20 -pthread -I../src -o fuzz_eng_format fuzz_eng_format.cpp eng_format_reference.cpp ../src/eng_format.cpp && fuzz_eng_format
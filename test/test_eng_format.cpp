@@ -21,15 +21,224 @@
 
 #include "lest.hpp"
 #include "eng_format.hpp"
+#include "eng_format_c.h"
 
+#if __cplusplus >= 202002L
+# include "eng_format_constexpr.hpp"
+#endif
+
+#include <algorithm>
+#include <chrono>
 #include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
 #include <iostream>
 #include <limits>
+#include <new>
 #include <string>
+#include <thread>
+#include <vector>
 
 std::string to_string( std::string  const & text ) { return text; };
 std::string to_string( char const * const   text ) { return text; };
 
+/*
+ * Count heap allocations, to verify that the buffer-based interface does
+ * not allocate. With glibc also count malloc() and friends, which catches
+ * allocations inside the C library (snprintf, strtod), not only operator new.
+ * Per thread, so that the workers of other tests do not race on it, and
+ * allocations_of() counts only those of the calling thread.
+ */
+thread_local std::size_t allocation_count = 0;
+
+#if defined( __GLIBC__ )
+
+extern "C" void * __libc_malloc( std::size_t size );
+extern "C" void * __libc_calloc( std::size_t count, std::size_t size );
+extern "C" void * __libc_realloc( void * ptr, std::size_t size );
+
+extern "C" void * malloc( std::size_t size )
+{
+    ++allocation_count;
+    return __libc_malloc( size );
+}
+
+extern "C" void * calloc( std::size_t count, std::size_t size )
+{
+    ++allocation_count;
+    return __libc_calloc( count, size );
+}
+
+extern "C" void * realloc( void * ptr, std::size_t size )
+{
+    ++allocation_count;
+    return __libc_realloc( ptr, size );
+}
+
+void * operator new( std::size_t size )
+{
+    if ( void * ptr = std::malloc( size ? size : 1 ) )
+    {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+#else
+
+void * operator new( std::size_t size )
+{
+    ++allocation_count;
+
+    if ( void * ptr = std::malloc( size ? size : 1 ) )
+    {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+#endif
+
+// GCC takes free() of what the replacement operator new returns for a mismatch:
+#if defined( __GNUC__ ) && __GNUC__ >= 11 && !defined( __clang__ )
+# pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+
+void operator delete( void * ptr ) noexcept
+{
+    std::free( ptr );
+}
+
+void * operator new[]( std::size_t size )
+{
+    return operator new( size );
+}
+
+void operator delete[]( void * ptr ) noexcept
+{
+    operator delete( ptr );
+}
+
+#if defined( __cpp_sized_deallocation )
+
+void operator delete( void * ptr, std::size_t ) noexcept
+{
+    operator delete( ptr );
+}
+
+void operator delete[]( void * ptr, std::size_t ) noexcept
+{
+    operator delete( ptr );
+}
+
+#endif
+
+template< typename F >
+std::size_t allocations_of( F f )
+{
+    const std::size_t before = allocation_count;
+    f();
+    return allocation_count - before;
+}
+
+/*
+ * an allocator that takes from a buffer and never gives back, like an arena.
+ */
+template< typename T >
+struct arena_allocator
+{
+    typedef T value_type;
+
+    arena_allocator( char * buffer, std::size_t * used, std::size_t capacity )
+    : buffer( buffer ), used( used ), capacity( capacity ) {}
+
+    template< typename U >
+    arena_allocator( arena_allocator<U> const & other )
+    : buffer( other.buffer ), used( other.used ), capacity( other.capacity ) {}
+
+    T * allocate( std::size_t n )
+    {
+        const std::size_t start = ( *used + alignof( T ) - 1 ) / alignof( T ) * alignof( T );
+
+        if ( start + n * sizeof( T ) > capacity )
+        {
+            throw std::bad_alloc();
+        }
+        *used = start + n * sizeof( T );
+        return reinterpret_cast<T *>( buffer + start );
+    }
+
+    void deallocate( T *, std::size_t ) {}
+
+    char * buffer;
+    std::size_t * used;
+    std::size_t capacity;
+};
+
+template< typename T, typename U >
+bool operator==( arena_allocator<T> const & a, arena_allocator<U> const & b ) { return a.buffer == b.buffer; }
+
+template< typename T, typename U >
+bool operator!=( arena_allocator<T> const & a, arena_allocator<U> const & b ) { return a.buffer != b.buffer; }
+
+/*
+ * values across the range of double: powers of ten with a few mantissas,
+ * both signs, zero, subnormals, extremes, NaN and infinity.
+ */
+std::vector<double> value_range()
+{
+    std::vector<double> values;
+
+    for ( int exponent = -324; exponent <= 308; ++exponent )
+    {
+        const double power = std::pow( 10.0, exponent );
+
+        values.push_back( power );
+        values.push_back( -9.9951 * power );
+        values.push_back( 4.5678 * power );
+    }
+
+    values.push_back( 0.0 );
+    values.push_back( -0.0 );
+    values.push_back( std::numeric_limits<double>::denorm_min() );
+    values.push_back( std::numeric_limits<double>::max() );
+    values.push_back( std::numeric_limits<double>::quiet_NaN() );
+    values.push_back( std::numeric_limits<double>::infinity() );
+    values.push_back( -std::numeric_limits<double>::infinity() );
+
+    return values;
+}
+
+/*
+ * the text of the parts of a value, as a custom renderer would make it.
+ */
+std::string assemble( eng_parts_t const & parts )
+{
+    if ( parts.special )
+    {
+        return parts.special;
+    }
+
+    std::string text( parts.negative ? "-" : "" );
+
+    for ( int i = 0; i < parts.count; ++i )
+    {
+        text += std::string( i == parts.point ? "." : "" ) + parts.digits[i];
+    }
+
+    if ( parts.prefix )
+    {
+        return text + ( *parts.prefix ? " " : "" ) + parts.prefix;
+    }
+
+    char exponent[ 8 ];
+    std::snprintf( exponent, sizeof exponent, "e%d", parts.exponent );
+
+    return text + exponent;
+}
+
 bool approx( double const a, double const b )
 {
 #if 0
@@ -334,6 +543,921 @@ const lest::test specification[] =
         EXPECT( "990 k" == step_engineering_string( "1.0 M"  , 3, eng_prefixed, eng_decrement ) );
         EXPECT( "990e3" == step_engineering_string( "1.0 M"  , 3, eng_exponential, eng_decrement ) );
     },
+
+    CASE( "number converts well to buffer" )
+    {
+        char text[ 32 ];
+
+        EXPECT( 8u == to_engineering_chars( text, sizeof text, 1230, 3, eng_prefixed, "Pa" ) );
+        EXPECT( "1.23 kPa" == std::string( text ) );
+
+        EXPECT( 9u == to_engineering_chars( text, sizeof text, 1230, 3, eng_exponential, "Pa" ) );
+        EXPECT( "1.23e3 Pa" == std::string( text ) );
+    },
+
+    CASE( "number truncates in too small buffer and reports the required length" )
+    {
+        char text[ 4 ] = "???";
+
+        EXPECT( 6u == to_engineering_chars( text, sizeof text, 1230, 3, eng_prefixed ) );
+        EXPECT( "1.2" == std::string( text ) );
+
+        EXPECT( 6u == to_engineering_chars( NULL, 0, 1230, 3, eng_prefixed ) );
+    },
+
+    CASE( "characters using prefix convert well to number" )
+    {
+        EXPECT( approx( 98.76e-3, from_engineering_chars( "98.76 m" ) ) );
+        EXPECT( approx( 98.76e-3, from_engineering_chars( "98.76e-3" ) ) );
+    },
+
+    CASE( "step succeeds into buffer" )
+    {
+        char text[ 32 ];
+
+        EXPECT( 6u == step_engineering_chars( text, sizeof text, "999 M", 3, eng_prefixed, eng_increment ) );
+        EXPECT( "1.00 G" == std::string( text ) );
+    },
+
+    CASE( "C interface formats, parses and steps" )
+    {
+        char text[ 32 ];
+
+        EXPECT( 8u == eng_format( text, sizeof text, 1230, 3, ENG_FORMAT_PREFIXED, "Pa" ) );
+        EXPECT( "1.23 kPa" == std::string( text ) );
+
+        EXPECT( 8u == eng_format( text, sizeof text, 1230, 3, ENG_FORMAT_EXPONENTIAL | ENG_FORMAT_NO_SEPARATOR, "Pa" ) );
+        EXPECT( "1.23e3Pa" == std::string( text ) );
+
+        EXPECT( 4u == eng_format( text, sizeof text, 1.23, 3, ENG_FORMAT_PREFIXED, NULL ) );
+        EXPECT( "1.23" == std::string( text ) );
+
+        EXPECT( approx( 98.76e-3, eng_parse( "98.76 m" ) ) );
+
+        EXPECT( 5u == eng_step( text, sizeof text, "1.0 M", 3, ENG_FORMAT_EXPONENTIAL, 0 ) );
+        EXPECT( "990e3" == std::string( text ) );
+
+        // stepping is decimal only:
+        EXPECT( 6u == eng_step( text, sizeof text, "1.00 k", 3, ENG_FORMAT_BINARY | ENG_FORMAT_NO_SEPARATOR, 1 ) );
+        EXPECT( "1.01 k" == std::string( text ) );
+
+        EXPECT( 7u == eng_format( text, sizeof text, 1536, 3, ENG_FORMAT_BINARY | ENG_FORMAT_NO_SEPARATOR, "B" ) );
+        EXPECT( "1.50KiB" == std::string( text ) );
+    },
+
+    CASE( "number converts well to string using binary prefix" )
+    {
+        EXPECT( "1023 B"    == to_engineering_string( 1023.0, 3, eng_binary, "B" ) );
+        EXPECT( "1.00 KiB"  == to_engineering_string( 1024.0, 3, eng_binary, "B" ) );
+        EXPECT( "1.50 Ki"   == to_engineering_string( 1536.0, 3, eng_binary ) );
+        EXPECT( "-2.00 Mi"  == to_engineering_string( -2097152.0, 3, eng_binary ) );
+        EXPECT( "977 Ki"    == to_engineering_string( 1e6, 3, eng_binary ) );
+        EXPECT( "1.50 Ti"   == to_engineering_string( 1.5 * 1099511627776.0, 3, eng_binary ) );
+        EXPECT( "1.25 Yi"   == to_engineering_string( 1.25 * 1208925819614629174706176.0, 3, eng_binary ) );
+
+        // rounding carries into the next prefix:
+        EXPECT( "1.00 Mi"   == to_engineering_string( 1023.999 * 1024, 3, eng_binary ) );
+
+        // no binary prefix for fractions and beyond 1023 Yi:
+        EXPECT( "500 m"     == to_engineering_string( 0.5, 3, eng_binary ) );
+        EXPECT( "1.24e27"   == to_engineering_string( 1024 * 1208925819614629174706176.0, 3, eng_binary ) );
+        EXPECT( "NaN"       == to_engineering_string( NAN, 3, eng_binary ) );
+    },
+
+    CASE( "integer converts exactly to string using binary prefix" )
+    {
+        const std::uint64_t largest = 18446744073709551615u;
+
+        EXPECT( "0.00 B"    == to_engineering_string( 0, 3, eng_binary, "B" ) );
+        EXPECT( "1.50 KiB"  == to_engineering_string( 1536, 3, eng_binary, "B" ) );
+        EXPECT( "-1.50 Ki"  == to_engineering_string( -1536, 3, eng_binary ) );
+        EXPECT( "2 Ki"      == to_engineering_string( 1536u, 1, eng_binary ) );
+        EXPECT( "1.00 Mi"   == to_engineering_string( 1048575LL, 3, eng_binary ) );
+        EXPECT( "16.0 Ei"   == to_engineering_string( largest, 3, eng_binary ) );
+
+        // beyond the precision of a double:
+        EXPECT( "15.999999999999999999 Ei" == to_engineering_string( largest, 20, eng_binary ) );
+        EXPECT( "1.5000000000000000009 Ei" == to_engineering_string( ( std::uint64_t( 3 ) << 59 ) + 1, 20, eng_binary ) );
+
+        char text[ 8 ];
+        EXPECT( 7u == to_engineering_chars( text, sizeof text, 1536, 3, eng_binary, "B", "" ) );
+        EXPECT( "1.50KiB" == std::string( text ) );
+    },
+
+    CASE( "integer and double give the same binary presentation" )
+    {
+        for ( std::uint64_t value = 1; value < ( std::uint64_t( 1 ) << 53 ); value = value * 3 + 1 )
+        {
+            for ( int digits = 1; digits <= 6; ++digits )
+            {
+                EXPECT( to_engineering_string( static_cast<double>( value ), digits, eng_binary ) == to_engineering_string( value, digits, eng_binary ) );
+            }
+        }
+    },
+
+    CASE( "string using binary prefix converts well to number" )
+    {
+        EXPECT( 1536.0              == from_engineering_string( "1.50 Ki" ) );
+        EXPECT( 2097152.0           == from_engineering_string( "2 MiB" ) );
+        EXPECT( 2e6                 == from_engineering_string( "2 MB" ) );
+        EXPECT( 1152921504606846976.0 == from_engineering_string( "1Ei" ) );
+        EXPECT( 1e-3                == from_engineering_string( "1 m" ) );
+    },
+
+    CASE( "integer converts exactly to string" )
+    {
+        const std::uint64_t largest = 18446744073709551615u;
+
+        EXPECT( "0.00"      == to_engineering_string( 0, 3, false ) );
+        EXPECT( "123"       == to_engineering_string( 123, 2, false ) );
+        EXPECT( "1.23 M"    == to_engineering_string( 1234567, 3, eng_prefixed ) );
+        EXPECT( "-1.00 M"   == to_engineering_string( -999999L, 3, eng_prefixed ) );
+        EXPECT( "2 k"       == to_engineering_string( 2500u, 1, eng_prefixed ) );
+        EXPECT( "4e3"       == to_engineering_string( 3500, 1, eng_exponential ) );
+
+        // beyond the precision of a double:
+        EXPECT( "9.007199254740993 P" == to_engineering_string( 9007199254740993LL, 16, eng_prefixed ) );
+        EXPECT( "18.446744073709551615 E" == to_engineering_string( largest, 20, eng_prefixed ) );
+        EXPECT( "-9.223372036854775808e18" == to_engineering_string( std::numeric_limits<std::int64_t>::min(), 19, eng_exponential ) );
+
+        char text[ 8 ];
+        EXPECT( 6u == to_engineering_chars( text, sizeof text, 1500, 3, eng_prefixed, "V", "" ) );
+        EXPECT( "1.50kV" == std::string( text ) );
+    },
+
+    CASE( "integer and double give the same presentation" )
+    {
+        for ( std::int64_t value = 1; value < ( std::int64_t( 1 ) << 53 ); value = value * 3 + 1 )
+        {
+            for ( int digits = 1; digits <= 9; ++digits )
+            {
+                EXPECT( to_engineering_string( static_cast<double>(  value ), digits, eng_prefixed    ) == to_engineering_string(  value, digits, eng_prefixed    ) );
+                EXPECT( to_engineering_string( static_cast<double>( -value ), digits, eng_exponential ) == to_engineering_string( -value, digits, eng_exponential ) );
+            }
+        }
+    },
+
+    CASE( "scaled integer converts exactly to string" )
+    {
+        EXPECT( "1.23 V"    == to_engineering_string( eng_decimal( 1234567, -6 ), 3, false, "V" ) );
+        EXPECT( "-15 mA"    == to_engineering_string( eng_decimal( -15, -3 ), 2, eng_prefixed, "A" ) );
+        EXPECT( "1.00e-6 V" == to_engineering_string( eng_decimal( 1u, -6 ), 3, eng_exponential, "V" ) );
+        EXPECT( "0.00"      == to_engineering_string( eng_decimal( 0, -6 ), 3, eng_prefixed ) );
+        EXPECT( "5e30"      == to_engineering_string( eng_decimal( 5, 30 ), 1, eng_prefixed ) );
+
+        char text[ 8 ];
+        EXPECT( 5u == to_engineering_chars( text, sizeof text, eng_decimal( 1234567, -6 ), 3, eng_prefixed, "V", "" ) );
+        EXPECT( "1.23V" == std::string( text ) );
+    },
+
+    CASE( "float converts to string as its double does, and back to the same float" )
+    {
+        for ( float value = 1.17549435e-38f; value < 3.4e38f; value *= 2.7182817f )
+        {
+            for ( int digits = 1; digits <= 9; ++digits )
+            {
+                EXPECT( to_engineering_string( static_cast<double>( value ), digits, eng_prefixed ) == to_engineering_string( value, digits, eng_prefixed ) );
+            }
+            EXPECT(  value == from_engineering_string<float>( to_engineering_string(  value, 9, eng_prefixed ) ) );
+            EXPECT( -value == from_engineering_string<float>( to_engineering_string( -value, 9, eng_exponential ) ) );
+        }
+
+        EXPECT( "1.50 kV" == to_engineering_string( 1.5e3f, 3, eng_prefixed, "V" ) );
+        EXPECT( 1500.0f   == from_engineering_string<float>( "1.50 kV" ) );
+        EXPECT( 1536.0f   == from_engineering_string<float>( "1.50 Ki" ) );
+    },
+
+    CASE( "column shares the degree of the largest magnitude, right-aligned in rows of one width" )
+    {
+        const double values[] = { 12.3e3, 0.45e3, 1.2e6, -7.5e3 };
+        char text[ 64 ];
+
+        const eng_column_t column = eng_column( values, 4, 3, false, "V" );
+
+        EXPECT( 2 == column.degree );
+        EXPECT( 2 == column.decimals );
+        EXPECT( 8 == column.width );
+        EXPECT( 32u == to_engineering_column( text, sizeof text, values, 4, column, false, "V" ) );
+        EXPECT( " 0.01 MV 0.00 MV 1.20 MV-0.01 MV" == std::string( text ) );
+    },
+
+    CASE( "column rounds the largest magnitude before choosing the degree, and rounds ties to even" )
+    {
+        const double values[] = { 999.96, 1.5, -0.25 };
+        char text[ 64 ];
+
+        const eng_column_t column = eng_column( values, 3, 4, false );
+
+        EXPECT( 24u == to_engineering_column( text, sizeof text, values, 3, column, false ) );
+        EXPECT( " 1.000 k 0.002 k-0.000 k" == std::string( text ) );
+    },
+
+    CASE( "column writes NaN and infinity, exponents, and fills rows that do not fit with '#'" )
+    {
+        const double values[] = { 1.5, 250, std::numeric_limits<double>::quiet_NaN() };
+        char text[ 64 ];
+
+        eng_column_t column = eng_column( values, 3, 3, true, "s" );
+
+        EXPECT( 21u == to_engineering_column( text, sizeof text, values, 3, column, true, "s" ) );
+        EXPECT( "  2e0 s250e0 s    NaN" == std::string( text ) );
+
+        column.width = 4;
+        EXPECT( 12u == to_engineering_column( text, sizeof text, values, 3, column, true, "s" ) );
+        EXPECT( "######## NaN" == std::string( text ) );
+    },
+
+    CASE( "column rows parse back to within half a unit in the last place" )
+    {
+        std::vector<double> values;
+        for ( int i = -500; i < 500; ++i )
+        {
+            values.push_back( i * 37.1 + i * i * 0.013 );
+        }
+
+        const eng_column_t column = eng_column( &values[0], values.size(), 5, false );
+        const double half_place = 0.5 * std::pow( 10.0, 3 * column.degree - column.decimals );
+
+        const std::size_t length = values.size() * column.width;
+
+        std::vector<char> text( length + 1 );
+        EXPECT( length == to_engineering_column( &text[0], text.size(), &values[0], values.size(), column, false ) );
+
+        for ( std::size_t i = 0; i < values.size(); ++i )
+        {
+            const std::string row( &text[ i * column.width ], column.width );
+
+            EXPECT( std::fabs( from_engineering_string( row ) - values[i] ) <= half_place * ( 1 + 1e-12 ) );
+        }
+    },
+
+    CASE( "axis ticks are 1, 2 or 5 x 10^k apart, their labels sharing one degree and number of decimals" )
+    {
+        double values[ 16 ];
+        char text[ 128 ];
+
+        const eng_ticks_t ticks = eng_axis_ticks( 0, 1200, 6, false, values, 16, text, sizeof text, "V" );
+
+        EXPECT( 7u  == ticks.count );
+        EXPECT( 6   == ticks.width );
+        EXPECT( 42u == ticks.length );
+        EXPECT( 0.0 == values[0] );
+        EXPECT( 1200.0 == values[6] );
+        EXPECT( "0.0 kV0.2 kV0.4 kV0.6 kV0.8 kV1.0 kV1.2 kV" == std::string( text ) );
+
+        const eng_ticks_t small = eng_axis_ticks( 0.0047, 0.0012, 5, false, values, 16, text, sizeof text, "A" );
+
+        EXPECT( 7u    == small.count );
+        EXPECT( 0.0015 == values[0] );
+        EXPECT( 0.0025 == values[2] );
+        EXPECT( "1.5 mA2.0 mA2.5 mA3.0 mA3.5 mA4.0 mA4.5 mA" == std::string( text ) );
+
+        EXPECT( "-400 m-200 m   0 m 200 m 400 m" == std::string( text, eng_axis_ticks( -0.5, 0.5, 4, false, values, 16, text, sizeof text ).length ) );
+    },
+
+    CASE( "axis ticks are at powers of ten on a logarithmic axis, each label with its own prefix" )
+    {
+        double values[ 16 ];
+        char text[ 128 ];
+
+        const eng_ticks_t ticks = eng_axis_ticks( 1e-3, 1e3, 7, true, values, 16, text, sizeof text, "Hz" );
+
+        EXPECT( 7u    == ticks.count );
+        EXPECT( 0.1   == values[2] );
+        EXPECT( "  1 mHz 10 mHz100 mHz   1 Hz  10 Hz 100 Hz  1 kHz" == std::string( text ) );
+
+        // every 3 decades or a multiple of it, from a multiple of it:
+        EXPECT( "1 p1 u  11 M1 T" == std::string( text, eng_axis_ticks( 1e-12, 1e12, 5, true, values, 16, text, sizeof text ).length ) );
+    },
+
+    CASE( "axis ticks are not written when more than fit, nor for a range they cannot have" )
+    {
+        double values[ 4 ];
+        char text[ 64 ] = "";
+
+        const eng_ticks_t ticks = eng_axis_ticks( 0, 1, 10, false, values, 4, text, sizeof text );
+
+        EXPECT( 11u == ticks.count );
+        EXPECT( ticks.length == ticks.count * ticks.width );
+        EXPECT( "" == std::string( text ) );
+
+        EXPECT( 0u == eng_axis_ticks( 0, 1, 5, true, values, 4, text, sizeof text ).count );
+        EXPECT( 0u == eng_axis_ticks( 0, std::numeric_limits<double>::quiet_NaN(), 5, false, values, 4, text, sizeof text ).count );
+    },
+
+    CASE( "display keeps the degree shown last within hysteresis, and does not flicker" )
+    {
+        eng_display_t display = eng_display( 3, 0.01, false, "V" );
+
+        const double values[] = { 0.998, 0.9996, 1.004, 1.0095, 1.005, 0.995, 0.9899, 0.98 };
+        const char * expected[] = { "998 mV", "1000 mV", "1004 mV", "1.01 V", "1.00 V", "0.995 V", "0.990 V", "980 mV" };
+
+        for ( int i = 0; i < 8; ++i )
+        {
+            char text[ 16 ];
+            to_engineering_display( text, sizeof text, display, values[i] );
+
+            EXPECT( expected[i] == std::string( text ) );
+        }
+    },
+
+    CASE( "display without hysteresis formats as to_engineering_chars() does" )
+    {
+        for ( int digits = 1; digits <= 4; ++digits )
+        {
+            eng_display_t display = eng_display( digits, 0, false, "s" );
+
+            for ( int i = 0; i < 2000; ++i )
+            {
+                const double value = ( i % 3 ? 1e-7 : -1e-7 ) * std::pow( 1.013, i );
+
+                char text[ 32 ];
+                const std::size_t length = to_engineering_display( text, sizeof text, display, value );
+
+                EXPECT( to_engineering_string( value, digits, eng_prefixed, "s" ) == std::string( text, length ) );
+            }
+        }
+
+        eng_display_t display = eng_display( 3, 0, false, "s" );
+
+        char text[ 16 ];
+        EXPECT( 3u == to_engineering_display( text, sizeof text, display, std::numeric_limits<double>::quiet_NaN() ) );
+        EXPECT( "NaN" == std::string( text ) );
+    },
+
+    CASE( "display keeps the degree through zero" )
+    {
+        eng_display_t display = eng_display( 3, 0.01, false, "V" );
+
+        const double values[] = { 0.005, 0, 0.0042 };
+        const char * expected[] = { "5.00 mV", "0.00 mV", "4.20 mV" };
+
+        for ( int i = 0; i < 3; ++i )
+        {
+            char text[ 16 ];
+            to_engineering_display( text, sizeof text, display, values[i] );
+
+            EXPECT( expected[i] == std::string( text ) );
+            EXPECT( -1 == display.degree );
+        }
+    },
+
+    CASE( "display formats a value within range in the degree kept, without finding its own" )
+    {
+        eng_display_t display = eng_display( 3, 0, false, "V" );
+
+        display.degree = 2;
+        display.low    = 0;
+        display.high   = 1e300;
+
+        const double values[] = { 1.5, 999.96, -0.0123, 2.5e9 };
+        const char * expected[] = { "0.00000150 MV", "0.00100 MV", "-0.0000000123 MV", "2500 MV" };
+
+        for ( int i = 0; i < 4; ++i )
+        {
+            char text[ 32 ];
+            to_engineering_display( text, sizeof text, display, values[i] );
+
+            EXPECT( expected[i] == std::string( text ) );
+            EXPECT( 2 == display.degree );
+            EXPECT( 0 == display.low );
+            EXPECT( 1e300 == display.high );
+        }
+    },
+
+    CASE( "duration converts to string in seconds, from its ticks" )
+    {
+        using namespace std::chrono;
+
+        EXPECT( "1.23 ms"   == to_engineering_string( nanoseconds( 1230000 ), 3, eng_prefixed ) );
+        EXPECT( "456 us"    == to_engineering_string( microseconds( 456 ), 3, eng_prefixed ) );
+        EXPECT( "2.00 s"    == to_engineering_string( seconds( 2 ), 3, false ) );
+        EXPECT( "-1.50 s"   == to_engineering_string( milliseconds( -1500 ), 3, eng_prefixed ) );
+        EXPECT( "1.50e-6 s" == to_engineering_string( nanoseconds( 1500 ), 3, eng_exponential ) );
+        EXPECT( "1.23 m"    == to_engineering_string( nanoseconds( 1230000 ), 3, eng_prefixed, "" ) );
+
+        // periods that are not a power of ten:
+        EXPECT( "120 s"     == to_engineering_string( minutes( 2 ), 3, eng_prefixed ) );
+        EXPECT( "3.60 ks"   == to_engineering_string( hours( 1 ), 3, eng_prefixed ) );
+        EXPECT( "333 ms"    == to_engineering_string( duration<int, std::ratio<1, 3> >( 1 ), 3, eng_prefixed ) );
+        EXPECT( "1.23 ms"   == to_engineering_string( duration<double>( 1.23e-3 ), 3, eng_prefixed ) );
+
+        // beyond the precision of a double:
+        EXPECT( "9.223372036854775807 Gs" == to_engineering_string( nanoseconds( std::numeric_limits<std::int64_t>::max() ), 19, eng_prefixed ) );
+
+        char text[ 8 ];
+        EXPECT( 6u == to_engineering_chars( text, sizeof text, microseconds( 1500 ), 3, eng_prefixed, "s", "" ) );
+        EXPECT( "1.50ms" == std::string( text ) );
+    },
+
+    CASE( "key of a value holds the digits shown, the exponent of the last one, the degree and the sign" )
+    {
+        const eng_key_t key = eng_key( -1234.5, 3 );
+
+        EXPECT( key.negative );
+        EXPECT( 123u == key.mantissa );
+        EXPECT( 1 == key.exponent );
+        EXPECT( 1 == key.degree );
+
+        // more digits before the decimal point than asked for, and a carry:
+        EXPECT( 123u  == eng_key( 123.4, 2 ).mantissa );
+        EXPECT( 100u  == eng_key( 99.96, 2 ).mantissa );
+        EXPECT( 0     == eng_key( 99.96, 2 ).exponent );
+        EXPECT( 0u    == eng_key( 0.0, 3 ).mantissa );
+
+        EXPECT( eng_key( std::numeric_limits<double>::quiet_NaN(), 3 ) != eng_key( std::numeric_limits<double>::infinity(), 3 ) );
+        EXPECT( eng_key( std::numeric_limits<double>::infinity(), 3 ) == eng_key( -std::numeric_limits<double>::infinity(), 3 ) );
+    },
+
+    CASE( "key of values is equal exactly when their text is equal" )
+    {
+        for ( int digits = 1; digits <= 19; digits += 3 )
+        {
+            double previous = 0.9985;
+
+            for ( double value = 0.9985; value < 1.0015; value += 0.0000173 )
+            {
+                const bool same_key  = eng_key( value, digits ) == eng_key( previous, digits );
+                const bool same_text = to_engineering_string( value, digits, false ) == to_engineering_string( previous, digits, false );
+
+                EXPECT( same_key == same_text );
+
+                previous = value;
+            }
+        }
+
+        EXPECT( eng_key( 0.5 + 1e-16, 3 ) == eng_key( 0.5, 3 ) );
+        EXPECT( eng_key( 1.2341e-250, 4 ) != eng_key( 1.2351e-250, 4 ) );
+        EXPECT( eng_key( 1.2341e-250, 4 ) == eng_key( 1.23449e-250, 4 ) );
+    },
+
+    CASE( "key of a value depends on the notation only for binary prefixes" )
+    {
+        const eng_key_t key = eng_key( 1536.0, 3, eng_binary );
+
+        EXPECT( 150u == key.mantissa );
+        EXPECT( -2 == key.exponent );
+        EXPECT( 1 == key.degree );
+
+        // same digits, other degree: "1.50 Ki" and "1.50":
+        EXPECT( key != eng_key( 1.5, 3, eng_binary ) );
+
+        EXPECT( eng_key( 1234.5, 3, eng_prefixed ) == eng_key( 1234.5, 3, eng_exponential ) );
+        EXPECT( eng_key( 0.5, 3, eng_binary ) == eng_key( 0.5, 3, eng_prefixed ) );
+
+        double previous = 1000.0;
+
+        for ( double value = 1000.0; value < 1100.0; value += 0.173 )
+        {
+            const bool same_key  = eng_key( value, 3, eng_binary ) == eng_key( previous, 3, eng_binary );
+            const bool same_text = to_engineering_string( value, 3, eng_binary ) == to_engineering_string( previous, 3, eng_binary );
+
+            EXPECT( same_key == same_text );
+
+            previous = value;
+        }
+    },
+
+    CASE( "parts of a value hold sign, digits, decimal point, degree and prefix or exponent" )
+    {
+        const eng_parts_t parts = eng_parts( -1234.5, 3, false );
+
+        EXPECT( parts.negative );
+        EXPECT( 3 == parts.count );
+        EXPECT( "123" == std::string( parts.digits ) );
+        EXPECT( 1 == parts.point );
+        EXPECT( 1 == parts.degree );
+        EXPECT( 3 == parts.exponent );
+        EXPECT( "k" == std::string( parts.prefix ) );
+        EXPECT( !parts.special );
+
+        EXPECT( !eng_parts( 1234.5, 3, true  ).prefix );
+        EXPECT( !eng_parts( 1e30,   3, false ).prefix );
+        EXPECT( "NaN" == std::string( eng_parts( std::numeric_limits<double>::quiet_NaN(), 3, false ).special ) );
+    },
+
+    CASE( "parts of a value assemble to its string" )
+    {
+        const std::vector<double> values = value_range();
+
+        for ( std::size_t i = 0; i < values.size(); ++i )
+        {
+            for ( int digits = 1; digits <= 7; digits += 3 )
+            {
+                EXPECT( to_engineering_string( values[i], digits, false ) == assemble( eng_parts( values[i], digits, false ) ) );
+                EXPECT( to_engineering_string( values[i], digits, true  ) == assemble( eng_parts( values[i], digits, true  ) ) );
+            }
+        }
+    },
+
+    CASE( "normalized text has the specified digits, prefix and unit, rounded on its decimal digits" )
+    {
+        EXPECT( "1.23 kPa" == normalize_engineering_string( "1234 Pa", 3, eng_prefixed, "Pa" ) );
+        EXPECT( "4.70 n"   == normalize_engineering_string( "0.0047 u", 3, eng_prefixed ) );
+        EXPECT( "4.70e-9"  == normalize_engineering_string( "0.0047 u", 3, eng_exponential ) );
+        EXPECT( "1.23 M"   == normalize_engineering_string( "1.23e6", 3, eng_prefixed ) );
+        EXPECT( "1.00 k"   == normalize_engineering_string( "999.96", 3, eng_prefixed ) );
+        EXPECT( "100"      == normalize_engineering_string( "99.5", 1, eng_prefixed ) );
+
+        // exact: 1.2345e-6 is not a tie to a double; half to even on decimal digits:
+        EXPECT( "1.23 u"   == normalize_engineering_string( "1.2345 u", 3, eng_prefixed ) );
+        EXPECT( "1.24 u"   == normalize_engineering_string( "1.2350 u", 3, eng_prefixed ) );
+        EXPECT( "1.22 u"   == normalize_engineering_string( "1.2250 u", 3, eng_prefixed ) );
+        EXPECT( "1.23 u"   == normalize_engineering_string( "1.22500000000000000000000000000000000000000000000001 u", 3, eng_prefixed ) );
+
+        EXPECT( "NaN"      == normalize_engineering_string( "NaN", 3, eng_prefixed ) );
+        EXPECT( ""         == normalize_engineering_string( "volt", 3, eng_prefixed ) );
+    },
+
+    CASE( "normalized text is that of the double, for text that a double holds exactly" )
+    {
+        // no milli and smaller, as 1e-3 is not exact in a double:
+        for ( int i = -4000; i < 4000; i += 7 )
+        {
+            char text[ 32 ];
+            std::snprintf( text, sizeof text, "%.4f%s", i * 0.0625, i % 2 ? " k" : "" );
+
+            EXPECT( to_engineering_string( from_engineering_string( text ), 3, false ) == normalize_engineering_string( text, 3, false ) );
+        }
+    },
+
+    CASE( "normalized texts follow one another in one buffer" )
+    {
+        char const * const texts[] = { "1234", "0.5 m", "oops", "-2e3" };
+        std::size_t offsets[ 4 ];
+        char buffer[ 64 ];
+
+        EXPECT( 25u == normalize_engineering_chars( buffer, sizeof buffer, texts, 4, offsets, 3, false, "V" ) );
+
+        EXPECT( "1.23 kV"  == std::string( buffer + offsets[0] ) );
+        EXPECT( "500 uV"   == std::string( buffer + offsets[1] ) );
+        EXPECT( ""         == std::string( buffer + offsets[2] ) );
+        EXPECT( "-2.00 kV" == std::string( buffer + offsets[3] ) );
+    },
+
+    CASE( "sort keys order text by value, as memcmp() compares them" )
+    {
+        char const * const texts[] =
+        {
+            "junk", "-INFINITE", "-1.5 k", "-999e0", "-1 m", "0", "-0.00", "1 a", "12e-3", "999.9 m", "1", "1.5 Ki", "2 k", "1 Y", "1e30", "INFINITE", "NaN",
+        };
+        const int count = sizeof texts / sizeof texts[0];
+
+        for ( int i = 1; i < count; ++i )
+        {
+            const eng_sort_key_t previous = eng_sort_key( texts[ i - 1 ] );
+            const eng_sort_key_t current  = eng_sort_key( texts[ i ] );
+
+            EXPECT( std::memcmp( previous.bytes, current.bytes, eng_sort_key_size ) <= 0 );
+            EXPECT( !( current < previous ) );
+        }
+
+        EXPECT( !( eng_sort_key( "0" ) < eng_sort_key( "-0.00" ) ) );
+        EXPECT( !( eng_sort_key( "1.50 k" ) < eng_sort_key( "1500" ) ) );
+        EXPECT( !( eng_sort_key( "1500" ) < eng_sort_key( "1.50 k" ) ) );
+        EXPECT( eng_sort_key( "100 Pa", "Pa" ) < eng_sort_key( "1 kPa", "Pa" ) );
+    },
+
+    CASE( "sort orders texts by value, stably, on several threads" )
+    {
+        std::vector<std::string> texts;
+        for ( int i = 0; i < 50000; ++i )
+        {
+            const double value = ( i % 3 ? 1 : -1 ) * std::pow( 10.0, ( i * 7919 ) % 4000 / 100.0 - 20 );
+            texts.push_back( to_engineering_string( value, 1 + i % 5, i % 4 == 0 ) );
+        }
+
+        std::vector<std::string> expected( texts );
+        std::stable_sort( expected.begin(), expected.end(), []( std::string const & a, std::string const & b ) { return eng_sort_key( a.c_str() ) < eng_sort_key( b.c_str() ); } );
+
+        eng_sort( &texts[0], texts.size(), "", 4 );
+
+        EXPECT( expected == texts );
+
+        char const * pointers[] = { "2 k", "1", "-3 m", "1.0" };
+        eng_sort( pointers, 4 );
+
+        EXPECT( "-3 m" == std::string( pointers[0] ) );
+        EXPECT( "1"    == std::string( pointers[1] ) );
+        EXPECT( "1.0"  == std::string( pointers[2] ) );
+        EXPECT( "2 k"  == std::string( pointers[3] ) );
+    },
+
+    CASE( "logger renders the values of each thread in order, on its own thread" )
+    {
+        struct line { int format; std::string text; std::thread::id thread; };
+        std::vector<line> lines;
+
+        std::vector<std::thread::id> loggers;
+        std::vector<std::thread> threads;
+        {
+            eng_logger logger( [&lines]( int format, char const * text, std::size_t length )
+            {
+                lines.push_back( { format, std::string( text, length ), std::this_thread::get_id() } );
+            }, 8192 );
+
+            const int volts = logger.add_format( 3, false, "V" );
+            const int amps  = logger.add_format( 4, true,  "A", "" );
+
+            for ( int t = 0; t < 2; ++t )
+            {
+                threads.emplace_back( [&logger, t, volts, amps]()
+                {
+                    logger.prepare();
+                    for ( int i = 0; i < 5000; ++i )
+                    {
+                        logger.log( t ? amps : volts, ( t ? -1 : 1 ) * std::pow( 1.01, i ) * 1e-12 );
+                    }
+                } );
+                loggers.push_back( threads.back().get_id() );
+            }
+
+            for ( std::size_t t = 0; t < threads.size(); ++t )
+            {
+                threads[t].join();
+            }
+
+            logger.flush();
+
+            EXPECT( 10000u == lines.size() + logger.dropped() );
+            EXPECT( 0u     == logger.dropped() );
+
+            logger.log( 0, 1234.5 );
+        }
+
+        std::size_t next[2] = { 0, 0 };
+
+        for ( std::size_t n = 0; n + 1 < lines.size(); ++n )
+        {
+            const int t = lines[n].format;
+            const std::size_t i = next[t]++;
+            const double value = ( t ? -1 : 1 ) * std::pow( 1.01, i ) * 1e-12;
+
+            EXPECT( lines[n].text == ( t ? to_engineering_string( value, 4, true, "A", "" ) : to_engineering_string( value, 3, false, "V" ) ) );
+            EXPECT( lines[n].thread != loggers[t] );
+        }
+
+        // the destructor renders what remains:
+        EXPECT( "1.23 kV" == lines.back().text );
+    },
+
+    CASE( "logger drops values when the ring of a thread is full, and counts them" )
+    {
+        std::size_t rendered = 0;
+        std::size_t logged   = 0;
+
+        eng_logger logger( [&rendered]( int, char const *, std::size_t ) { ++rendered; }, 2 );
+        const int format = logger.add_format( 3, false );
+
+        for ( int i = 0; i < 100000; ++i )
+        {
+            logged += logger.log( format, i );
+        }
+
+        logger.flush();
+
+        EXPECT( 100000u == logged + logger.dropped() );
+        EXPECT( logged  == rendered );
+    },
+
+    CASE( "long double converts to string with all its digits, and back" )
+    {
+        EXPECT( "-2.50 m"   == to_engineering_string( -2.5e-3L, 3, false ) );
+        EXPECT( 0.1L        == from_engineering_string<long double>( "100 m" ) );
+        EXPECT( 1.5e3       == from_engineering_string<double>( "1.5 k" ) );
+
+        if ( std::numeric_limits<long double>::max_exponent10 > 400 )
+        {
+            EXPECT( "10.0e399" == to_engineering_string( 1e400L, 3, eng_prefixed ) );
+            EXPECT( 1e400L     == from_engineering_string<long double>( "10.0e399" ) );
+        }
+
+        if ( std::numeric_limits<long double>::digits >= 64 )
+        {
+            const long double value = 1.0L + std::ldexp( 1.0L, -60 );
+
+            EXPECT( "1.0000000000000000009" == to_engineering_string( value, 20, eng_prefixed ) );
+            EXPECT( value == from_engineering_string<long double>( "1.0000000000000000009" ) );
+            EXPECT( value == from_engineering_string<long double>( "1000.0000000000000009 m" ) );
+        }
+    },
+
+    CASE( "buffer-based interface does not allocate across the value range" )
+    {
+        const std::vector<double> values = value_range();
+
+        std::size_t count = 0;
+        char text[ 80 ];
+
+        for ( std::size_t i = 0; i < values.size(); ++i )
+        {
+            for ( int digits = 1; digits <= eng_max_digits; ++digits )
+            {
+                const double value = values[i];
+
+                count += allocations_of( [&]()
+                {
+                    to_engineering_chars( text, sizeof text, value, digits, eng_prefixed, "V" );
+                    from_engineering_chars( text );
+                    to_engineering_chars( text, sizeof text, value, digits, eng_exponential, "V" );
+                    from_engineering_chars( text );
+                    step_engineering_chars( text, sizeof text, text, digits, eng_prefixed, eng_increment );
+                    step_engineering_chars( text, sizeof text, text, digits, eng_exponential, eng_decrement );
+                } );
+            }
+        }
+
+        EXPECT( 0u == count );
+    },
+
+    CASE( "C interface does not allocate across the value range" )
+    {
+        const std::vector<double> values = value_range();
+
+        std::size_t count = 0;
+        char text[ 80 ];
+
+        for ( std::size_t i = 0; i < values.size(); ++i )
+        {
+            const double value = values[i];
+
+            count += allocations_of( [&]()
+            {
+                eng_format( text, sizeof text, value, 3, ENG_FORMAT_PREFIXED, "V" );
+                eng_parse( text );
+                eng_step( text, sizeof text, text, 3, ENG_FORMAT_EXPONENTIAL, 1 );
+            } );
+        }
+
+        EXPECT( 0u == count );
+    },
+
+    CASE( "std::string interface allocations per call are reported" )
+    {
+        EXPECT( 0u < allocations_of( []() { std::string( 100, 'x' ); } ) );
+
+        const std::vector<double> values = value_range();
+
+        std::size_t to_count = 0, from_count = 0, step_count = 0;
+
+        // 16 digits and a long unit: longer than the small-string buffer of
+        // std::string, which would otherwise hide the allocations:
+        for ( std::size_t i = 0; i < values.size(); ++i )
+        {
+            const double value = values[i];
+            std::string text;
+
+            to_count   += allocations_of( [&]() { text = to_engineering_string( value, 16, eng_prefixed, "V/sqrt(Hz)" ); } );
+            from_count += allocations_of( [&]() { from_engineering_string( text ); } );
+            step_count += allocations_of( [&]() { step_engineering_string( text, 16, eng_prefixed, eng_increment ); } );
+        }
+
+        const double calls = static_cast<double>( values.size() );
+
+        EXPECT( 0u < to_count );
+
+        std::cout <<
+            "allocations per call: "
+            "to_engineering_string: "     << to_count   / calls <<
+            ", from_engineering_string: " << from_count / calls <<
+            ", step_engineering_string: " << step_count / calls << "\n";
+    },
+
+    CASE( "allocator-aware interface allocates through the given allocator only" )
+    {
+        typedef std::basic_string< char, std::char_traits<char>, arena_allocator<char> > arena_string;
+
+        char buffer[ 256 ];
+        std::size_t used = 0;
+        const arena_allocator<char> arena( buffer, &used, sizeof buffer );
+
+        arena_string text( arena );
+
+        EXPECT( 0u == allocations_of( [&]() { text = to_engineering_string( std::allocator_arg, arena, 1.234567890123456e3, 16, eng_prefixed, "Hz" ); } ) );
+        EXPECT( "1.234567890123456 kHz" == std::string( text.c_str() ) );
+        EXPECT( 0u < used );
+
+        EXPECT( 0u == allocations_of( [&]() { text = to_engineering_string( std::allocator_arg, arena, std::chrono::nanoseconds( 123456789012345678 ), 18, false ); } ) );
+        EXPECT( "123.456789012345678 Ms" == std::string( text.c_str() ) );
+
+        EXPECT( "1.50 kV"  == std::string( to_engineering_string( std::allocator_arg, arena, 1.5e3, 3, false, "V" ).c_str() ) );
+        EXPECT( "1.50e3 V" == std::string( to_engineering_string( std::allocator_arg, arena, 1500, 3, eng_exponential, "V" ).c_str() ) );
+        EXPECT( "1.50 KiB" == std::string( to_engineering_string( std::allocator_arg, arena, 1536, 3, eng_binary, "B" ).c_str() ) );
+        EXPECT( "1.01 k"   == std::string( step_engineering_string( std::allocator_arg, arena, "1.00 k", 3, eng_prefixed, eng_increment ).c_str() ) );
+        EXPECT( step_engineering_string( "1.00e3", 3, true, eng_decrement ) == step_engineering_string( std::allocator_arg, arena, "1.00e3", 3, true, eng_decrement ).c_str() );
+    },
+
+#if ENG_FORMAT_HAVE_PMR
+    CASE( "std::pmr interface allocates from the memory resource only" )
+    {
+        char buffer[ 256 ];
+        std::pmr::monotonic_buffer_resource arena( buffer, sizeof buffer, std::pmr::null_memory_resource() );
+
+        std::pmr::string text( &arena );
+
+        EXPECT( 0u == allocations_of( [&]() { text = to_engineering_string( &arena, -0.0048828125, 20, eng_prefixed, "farad" ); } ) );
+        EXPECT( "-4.8828125000000000000 mfarad" == std::string( text.c_str() ) );
+        EXPECT( &arena == text.get_allocator().resource() );
+
+        EXPECT( 0u == allocations_of( [&]() { text = step_engineering_string( &arena, "999 m", 3, eng_prefixed, eng_increment ); } ) );
+        EXPECT( "1.00" == std::string( text.c_str() ) );
+    },
+#endif
+
+    CASE( "largest magnitude ignores NaN and infinity, for any length and position" )
+    {
+        const std::string isa = eng_format_isa();
+
+        EXPECT( ( isa == "avx512" || isa == "avx2" || isa == "sse2" || isa == "generic" ) );
+
+        EXPECT( 0.0 == eng_max_magnitude( NULL, 0 ) );
+
+        for ( std::size_t count = 1; count < 40; ++count )
+        {
+            for ( std::size_t at = 0; at < count; ++at )
+            {
+                std::vector<double> values( count );
+                for ( std::size_t i = 0; i < count; ++i )
+                {
+                    values[i] = ( i % 2 ? -1.0 : 1.0 ) * ( i + 1 ) * 1e-3;
+                }
+
+                values[ ( at + 1 ) % count ] = NAN;
+                values[ ( at + 2 ) % count ] = -INFINITY;
+                values[ at ] = -7.5e300;
+
+                EXPECT( 7.5e300 == eng_max_magnitude( &values[0], count ) );
+
+                values[ at ] = NAN;
+
+                double expected = 0;
+                for ( std::size_t i = 0; i < count; ++i )
+                {
+                    if ( std::isfinite( values[i] ) ) expected = (std::max)( expected, std::fabs( values[i] ) );
+                }
+                EXPECT( expected == eng_max_magnitude( &values[0], count ) );
+            }
+        }
+    },
+
+#if ENG_FORMAT_STATS
+    CASE( "usage is counted over all threads, including ended ones" )
+    {
+        const eng_format_stats before = eng_format_statistics();
+
+        std::thread worker( []()
+        {
+            to_engineering_string( 1e30, 3, eng_prefixed );
+            from_engineering_string( "Howdie" );
+        } );
+        worker.join();
+
+        to_engineering_string( 1.0, 3, eng_exponential );
+        to_engineering_string( NAN, 3, eng_prefixed );
+        to_engineering_string( INFINITY, 3, eng_prefixed );
+        step_engineering_string( "1.00 k", 3, eng_prefixed, eng_increment );
+
+        const eng_format_stats after = eng_format_statistics();
+
+        EXPECT( 4u == after.prefixed          - before.prefixed );
+        EXPECT( 1u == after.exponential       - before.exponential );
+        EXPECT( 1u == after.exponent_fallback - before.exponent_fallback );
+        EXPECT( 1u == after.nan               - before.nan );
+        EXPECT( 1u == after.infinite          - before.infinite );
+        EXPECT( 2u == after.parses            - before.parses );
+        EXPECT( 1u == after.parse_failures    - before.parse_failures );
+        EXPECT( 1u == after.steps             - before.steps );
+    },
+#endif
+
+#if __cplusplus >= 202002L
+    CASE( "number converts well to string at compile time" )
+    {
+        constexpr auto clock = to_engineering_fixed( 10e3, 3, eng_prefixed, "Hz" );
+        constexpr auto limit = to_engineering_fixed( 3.3, 3, eng_exponential, "V" );
+
+        static_assert( std::string_view( clock ) == "10.0 kHz" );
+        static_assert( std::string_view( limit ) == "3.30e0 V" );
+
+        EXPECT( "10.0 kHz" == std::string( clock.c_str() ) );
+        EXPECT( "3.30e0 V" == std::string( limit.c_str() ) );
+    },
+
+    CASE( "number converts to the same string at compile time and at run time" )
+    {
+        constexpr double values[] = { 0.0, -0.0, 1.0, 999.9999e-27, 99.951e-21, 1e98, -1e-98, 5e-324, 1.7976931348623157e308,
+                                      123.4e-3, 999.5, -999.96e6, 1035.0, 1.045e-9, 2.5e-6, 0.1, 1.0 / 3.0, 2.2250738585072014e-308 };
+
+        for ( double value : values )
+        {
+            for ( int digits = 1; digits <= 17; ++digits )
+            {
+                EXPECT( to_engineering_string( value, digits, eng_prefixed   , "V" ) == std::string( to_engineering_fixed<64>( value, digits, eng_prefixed   , "V" ).c_str() ) );
+                EXPECT( to_engineering_string( value, digits, eng_exponential, "V" ) == std::string( to_engineering_fixed<64>( value, digits, eng_exponential, "V" ).c_str() ) );
+            }
+        }
+    },
+#endif
 };
 
 int main( int argc, char* argv[] )
@@ -346,5 +1470,5 @@ int main( int argc, char* argv[] )
 // compilation control to test C routine to_engineering_string_units(): -DTEST_C_VERSION_BY_DH
 
 
-// cl -nologo -W3 -EHsc -DENG_FORMAT_MICRO_GLYPH=\"u\" -I../src test_eng_format.cpp ../src/eng_format.cpp && test_eng_format
-// g++ -Wall -Wextra -std=c++11 -Wno-missing-braces -DENG_FORMAT_MICRO_GLYPH=\"u\" -I../src -o test_eng_format.exe test_eng_format.cpp ../src/eng_format.cpp && test_eng_format
+// cl -nologo -W3 -EHsc -DENG_FORMAT_MICRO_GLYPH=\"u\" -I../src test_eng_format.cpp ../src/eng_format.cpp ../src/eng_format_c.cpp && test_eng_format
+// g++ -Wall -Wextra -std=c++11 -Wno-missing-braces -pthread -DENG_FORMAT_MICRO_GLYPH=\"u\" -I../src -o test_eng_format.exe test_eng_format.cpp ../src/eng_format.cpp ../src/eng_format_c.cpp && test_eng_format
@@ -0,0 +1,864 @@
+// Copyright (C) 2013 by Martin Moene
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+// engfmt: convert the numbers in text to or from engineering notation, like
+// numfmt(1) does for its scales. Converts every number in the text, or the
+// selected fields of each line. Regular files are mapped into memory, other
+// input is read in large blocks. Lines are converted in batches, optionally
+// on several threads, and written in their original order.
+//
+//   engfmt [option...] [file...]
+
+#include "eng_format.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <charconv>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined( __unix__ ) || defined( __APPLE__ )
+# define ENGFMT_MMAP  1
+# include <fcntl.h>
+# include <sys/mman.h>
+# include <sys/stat.h>
+# include <unistd.h>
+#else
+# define ENGFMT_MMAP  0
+#endif
+
+namespace {
+
+char const usage[] =
+    "usage: engfmt [option...] [file...]\n"
+    "\n"
+    "Convert the numbers in the files, or standard input, to engineering notation.\n"
+    "\n"
+    "  -r, --from-eng        convert from engineering notation to plain numbers\n"
+    "  -d, --digits N        significant digits, default 3\n"
+    "  -e, --exponential     exponential notation, 1.23e3, instead of prefixes\n"
+    "  -b, --binary          binary prefixes, Ki, Mi, etc.\n"
+    "  -u, --unit TEXT       unit after the prefix, default none\n"
+    "  -s, --separator TEXT  text between number and prefix, default \" \"\n"
+    "  -f, --field LIST      convert fields, e.g. 2,4-6, instead of all numbers\n"
+    "  -t, --delimiter C     field delimiter, default blanks\n"
+    "  -j, --threads N       convert on N threads, 0 for all cores, default 1\n"
+    "  -h, --help            show this text\n";
+
+// lines are converted in batches of about this many bytes per thread:
+const std::size_t batch_size = std::size_t( 4 ) << 20;
+
+struct options
+{
+    bool from_eng    = false;
+    int  digits      = 3;
+    bool exponential = false;
+    bool binary      = false;
+    std::string unit;
+    std::string separator = " ";
+    std::vector<bool> fields;               // empty: all numbers in the text
+    char delimiter   = 0;                   // 0: blanks
+    unsigned threads = 1;
+};
+
+bool is_blank( char const c )
+{
+    return ' ' == c || '\t' == c;
+}
+
+bool is_digit( char const c )
+{
+    return '0' <= c && c <= '9';
+}
+
+// a number is not part of a word, a version such as 1.2.3 or a hex number:
+bool is_word( char const c )
+{
+    return is_digit( c ) || ( 'a' <= c && c <= 'z' ) || ( 'A' <= c && c <= 'Z' ) || '_' == c || '.' == c || ( c & 0x80 );
+}
+
+bool starts_with( char const * const pos, char const * const end, std::string const & text )
+{
+    return !text.empty() && std::size_t( end - pos ) >= text.size() && 0 == memcmp( pos, text.data(), text.size() );
+}
+
+/*
+ * a decimal prefix and its exponent, or a binary prefix and its degree.
+ */
+struct scale
+{
+    char const * text;
+    int exponent;
+    int degree;
+};
+
+// longest first, so that "Mi" is not taken for "M":
+scale const prefixes[] =
+{
+    { "Ki", 0, 1 }, { "Mi", 0, 2 }, { "Gi", 0, 3 }, { "Ti", 0, 4 }, { "Pi", 0, 5 }, { "Ei", 0, 6 }, { "Zi", 0, 7 }, { "Yi", 0, 8 },
+    { "\xC2\xB5", -6, 0 }, { "\xCE\xBC", -6, 0 },
+    { "y", -24, 0 }, { "z", -21, 0 }, { "a", -18, 0 }, { "f", -15, 0 }, { "p", -12, 0 }, { "n",  -9, 0 },
+    { "u",  -6, 0 }, { "\xB5", -6, 0 }, { "m",  -3, 0 },
+    { "k",   3, 0 }, { "M",   6, 0 }, { "G",   9, 0 }, { "T",  12, 0 }, { "P",  15, 0 }, { "E",  18, 0 },
+    { "Z",  21, 0 }, { "Y",  24, 0 },
+};
+
+/*
+ * a number in text, such as "-0.0470e3 k": its digits without leading zeros,
+ * and the prefix and unit that follow it.
+ */
+struct number
+{
+    char const * begin;
+    char const * end;
+    bool negative;
+    int  exponent;                          // of the first digit
+    std::string digits;
+    scale const * prefix;
+    bool unit;
+};
+
+scale const * read_prefix( char const * const pos, char const * const end )
+{
+    if ( pos == end )
+    {
+        return nullptr;
+    }
+
+    for ( scale const & p : prefixes )
+    {
+        const std::size_t length = strlen( p.text );
+
+        if ( p.text[0] == *pos && std::size_t( end - pos ) >= length && 0 == memcmp( pos, p.text, length ) )
+        {
+            return &p;
+        }
+    }
+    return nullptr;
+}
+
+/*
+ * read a number at pos, that starts at the start of a word: its end, pos if
+ * there is none. A sign only belongs to the number at the start of a word.
+ */
+char const * read_number( char const * const begin, char const * const pos, char const * const end, number & result )
+{
+    char const * p = pos;
+
+    result.begin    = pos;
+    result.negative = false;
+    result.exponent = -1;
+    result.digits.clear();
+
+    if ( p != end && ( '-' == *p || '+' == *p ) && ( p == begin || !is_word( p[-1] ) ) )
+    {
+        result.negative = '-' == *p++;
+    }
+
+    if ( p != begin && is_word( p[-1] ) )
+    {
+        return pos;
+    }
+
+    bool any = false, point = false;
+
+    for ( ; p != end && ( is_digit( *p ) || ( '.' == *p && !point ) ); ++p )
+    {
+        if ( '.' == *p )
+        {
+            point = true;
+            continue;
+        }
+
+        any = true;
+
+        if ( result.digits.empty() && '0' == *p ) { if ( point ) --result.exponent; }
+        else                                      { result.digits += *p; if ( !point ) ++result.exponent; }
+    }
+
+    if ( !any )
+    {
+        return pos;
+    }
+
+    if ( p != end && ( 'e' == *p || 'E' == *p ) )
+    {
+        char const * q = p + 1;
+        const bool negative = q != end && '-' == *q;
+        q += q != end && ( '-' == *q || '+' == *q );
+
+        if ( q != end && is_digit( *q ) )
+        {
+            int exponent = 0;
+
+            for ( ; q != end && is_digit( *q ); ++q )
+            {
+                exponent = (std::min)( 10 * exponent + ( *q - '0' ), 100000 );
+            }
+            result.exponent += negative ? -exponent : exponent;
+            p = q;
+        }
+    }
+
+    if ( result.digits.empty() )
+    {
+        result.exponent = 0;
+    }
+
+    result.end = p;
+    return p;
+}
+
+/*
+ * converts lines of text; shares no mutable state, so that it can convert
+ * batches on several threads.
+ */
+class converter
+{
+public:
+    explicit converter( options const & opt )
+    : opt( opt ) {}
+
+    void convert( char const * begin, char const * const end, std::string & out ) const
+    {
+        while ( begin != end )
+        {
+            char const * const eol = static_cast<char const *>( memchr( begin, '\n', end - begin ) );
+            char const * const stop = eol ? eol : end;
+
+            if ( opt.fields.empty() ) convert_text  ( begin, stop, out );
+            else                      convert_fields( begin, stop, out );
+
+            if ( !eol )
+            {
+                break;
+            }
+            out += '\n';
+            begin = eol + 1;
+        }
+    }
+
+private:
+    /*
+     * every number in the text, that is a word of its own.
+     */
+    void convert_text( char const * const begin, char const * const end, std::string & out ) const
+    {
+        number n;
+        char const * copied = begin;
+
+        for ( char const * pos = begin; pos != end; )
+        {
+            if ( !is_digit( *pos ) && '.' != *pos && '-' != *pos && '+' != *pos )
+            {
+                ++pos;
+                continue;
+            }
+
+            char const * const tail = convertible( begin, pos, end, false, n );
+
+            if ( tail == pos )
+            {
+                // a sign may stand on its own, a digit is part of a word:
+                if ( is_word( *pos ) ) for ( ++pos; pos != end && is_word( *pos ); ++pos ) {}
+                else                   ++pos;
+                continue;
+            }
+
+            out.append( copied, n.begin );
+            put( n, out );
+            copied = pos = tail;
+        }
+        out.append( copied, end );
+    }
+
+    /*
+     * the selected fields that hold a number and nothing else; blanks around
+     * it stay.
+     */
+    void convert_fields( char const * const begin, char const * const end, std::string & out ) const
+    {
+        number n;
+        char const * pos = begin;
+
+        for ( std::size_t field = 1; ; ++field )
+        {
+            char const * stop;
+
+            if ( opt.delimiter )
+            {
+                stop = static_cast<char const *>( memchr( pos, opt.delimiter, end - pos ) );
+                stop = stop ? stop : end;
+            }
+            else
+            {
+                for ( stop = pos; stop != end && is_blank( *stop ); ++stop ) {}
+                for (           ; stop != end && !is_blank( *stop ); ++stop ) {}
+            }
+
+            char const * first = pos;
+            char const * last  = stop;
+
+            for ( ; first != last && is_blank( *first    ); ++first ) {}
+            for ( ; last != first && is_blank( last[-1]  ); --last  ) {}
+
+            if ( field < opt.fields.size() && opt.fields[field] && first != last && last == convertible( first, first, last, true, n ) )
+            {
+                out.append( pos, first );
+                put( n, out );
+                out.append( last, stop );
+            }
+            else
+            {
+                out.append( pos, stop );
+            }
+
+            if ( stop == end )
+            {
+                break;
+            }
+
+            if ( opt.delimiter )
+            {
+                out += opt.delimiter;
+                pos = stop + 1;
+            }
+            else
+            {
+                pos = stop;
+            }
+        }
+    }
+
+    /*
+     * the end of the number at pos that converts, pos if none. From engineering
+     * notation, the number takes a prefix and unit that directly follow it, or
+     * after blanks if they end in the unit, or if the number is a field.
+     */
+    char const * convertible( char const * const begin, char const * const pos, char const * const end, bool const field, number & n ) const
+    {
+        char const * tail = read_number( begin, pos, end, n );
+
+        if ( tail == pos )
+        {
+            return pos;
+        }
+
+        n.prefix = nullptr;
+        n.unit   = false;
+
+        if ( opt.from_eng )
+        {
+            char const * p = tail;
+            for ( ; p != end && is_blank( *p ); ++p ) {}
+
+            // the unit alone, "5 m" with unit "m", is no prefix:
+            char const * q = p + opt.unit.size();
+            scale const * pre = nullptr;
+            bool unit = starts_with( p, end, opt.unit ) && ( q == end || !is_word( *q ) );
+
+            if ( !unit )
+            {
+                pre  = read_prefix( p, end );
+                q    = pre ? p + strlen( pre->text ) : p;
+                unit = starts_with( q, end, opt.unit );
+                q   += unit ? opt.unit.size() : 0;
+            }
+
+            if ( q != p && ( q == end || !is_word( *q ) ) && ( p == tail || unit || field ) )
+            {
+                n.prefix = pre;
+                n.unit   = unit;
+                tail     = q;
+            }
+        }
+
+        return tail == end || !is_word( *tail ) ? tail : pos;
+    }
+
+    void put( number const & n, std::string & out ) const
+    {
+        if ( opt.from_eng ) put_plain( n, out );
+        else                put_engineering( n, out );
+    }
+
+    void put_engineering( number const & n, std::string & out ) const
+    {
+        char text[ 128 ];
+
+        if ( std::size_t( n.end - n.begin ) >= sizeof text )
+        {
+            out.append( n.begin, n.end );
+            return;
+        }
+
+        memcpy( text, n.begin, n.end - n.begin );
+        text[ n.end - n.begin ] = '\0';
+
+        const std::size_t room = 64 + opt.unit.size() + opt.separator.size();
+        const std::size_t size = out.size();
+
+        out.resize( size + room );
+
+        const std::size_t length = opt.binary
+            ? to_engineering_chars( &out[size], room, strtod( text, nullptr ), opt.digits, eng_binary, opt.unit.c_str(), opt.separator.c_str() )
+            : normalize_engineering_chars( &out[size], room, text, opt.digits, opt.exponential, opt.unit.c_str(), opt.separator.c_str() );
+
+        out.resize( size + (std::min)( length, room - 1 ) );
+    }
+
+    /*
+     * the exact digits with the prefix applied, without exponent as long as
+     * that stays readable; a binary prefix goes through a double.
+     */
+    void put_plain( number const & n, std::string & out ) const
+    {
+        if ( n.prefix && n.prefix->degree )
+        {
+            char text[ 128 ];
+            const std::size_t length = (std::min)( std::size_t( n.end - n.begin ), sizeof text - 1 );
+
+            memcpy( text, n.begin, length );
+            text[ length ] = '\0';
+
+            char result[ 32 ];
+            const std::to_chars_result r = std::to_chars( result, result + sizeof result, std::ldexp( strtod( text, nullptr ), 10 * n.prefix->degree ) );
+            out.append( result, r.ptr );
+        }
+        else
+        {
+            std::string const & digits = n.digits;
+            const std::size_t count = digits.size();
+            const int exponent = n.exponent + ( n.prefix ? n.prefix->exponent : 0 );
+
+            if ( n.negative && count )
+            {
+                out += '-';
+            }
+
+            if ( 0 == count )
+            {
+                out += '0';
+            }
+            else if ( exponent < -30 || exponent > 30 )
+            {
+                char text[ 16 ];
+
+                out += digits[0];
+                put_fraction( digits.data() + 1, count - 1, 0, out );
+                out.append( text, snprintf( text, sizeof text, "e%d", exponent ) );
+            }
+            else if ( exponent >= 0 )
+            {
+                const std::size_t integral = exponent + 1;
+
+                out.append( digits, 0, integral );
+                if ( count < integral ) out.append( integral - count, '0' );
+                else                    put_fraction( digits.data() + integral, count - integral, 0, out );
+            }
+            else
+            {
+                out += '0';
+                put_fraction( digits.data(), count, -exponent - 1, out );
+            }
+        }
+
+        if ( n.unit )
+        {
+            out += opt.separator;
+            out += opt.unit;
+        }
+    }
+
+    // the fraction after the given number of zeros, without trailing zeros:
+    static void put_fraction( char const * const fraction, std::size_t length, std::size_t const zeros, std::string & out )
+    {
+        for ( ; length && '0' == fraction[ length - 1 ]; --length ) {}
+
+        if ( length )
+        {
+            out += '.';
+            out.append( zeros, '0' );
+            out.append( fraction, length );
+        }
+    }
+
+    options const & opt;
+};
+
+/*
+ * the input of a file as consecutive batches of whole lines, the last
+ * possibly without newline: mapped into memory, or read in large blocks.
+ */
+class source
+{
+public:
+    source( char const * const name )
+    : name( name )
+    {
+        if ( 0 == strcmp( name, "-" ) )
+        {
+            file = stdin;
+            return;
+        }
+#if ENGFMT_MMAP
+        const int fd = open( name, O_RDONLY );
+        struct stat info;
+
+        if ( fd >= 0 && 0 == fstat( fd, &info ) && S_ISREG( info.st_mode ) && info.st_size > 0 )
+        {
+            void * const map = mmap( nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0 );
+
+            if ( MAP_FAILED != map )
+            {
+                madvise( map, info.st_size, MADV_SEQUENTIAL );
+                mapped = static_cast<char const *>( map );
+                size   = info.st_size;
+                close( fd );
+                return;
+            }
+        }
+        if ( fd >= 0 )
+        {
+            close( fd );
+        }
+#endif
+        file = std::fopen( name, "rb" );
+    }
+
+    ~source()
+    {
+#if ENGFMT_MMAP
+        if ( mapped )
+        {
+            munmap( const_cast<char *>( mapped ), size );
+        }
+#endif
+        if ( file && file != stdin )
+        {
+            std::fclose( file );
+        }
+    }
+
+    bool good() const
+    {
+        return mapped || file;
+    }
+
+    /*
+     * the next batch of about the given size, false at the end of the input.
+     */
+    bool next( std::size_t const wanted, char const *& begin, char const *& end )
+    {
+        return mapped ? next_mapped( wanted, begin, end ) : next_read( wanted, begin, end );
+    }
+
+    bool failed() const
+    {
+        return file && std::ferror( file );
+    }
+
+    char const * const name;
+
+private:
+    bool next_mapped( std::size_t const wanted, char const *& begin, char const *& end )
+    {
+        if ( offset == size )
+        {
+            return false;
+        }
+
+        begin  = mapped + offset;
+        end    = line_end( begin, mapped + (std::min)( size, offset + wanted ), mapped + size );
+        offset = end - mapped;
+        return true;
+    }
+
+    bool next_read( std::size_t const wanted, char const *& begin, char const *& end )
+    {
+        // keep the incomplete line of the previous batch:
+        buffer.erase( 0, offset );
+        offset = 0;
+
+        while ( !std::feof( file ) && !std::ferror( file ) )
+        {
+            if ( buffer.size() >= wanted )
+            {
+                std::size_t length = buffer.size();
+                for ( ; length && '\n' != buffer[ length - 1 ]; --length ) {}
+
+                if ( length )
+                {
+                    begin  = buffer.data();
+                    end    = begin + length;
+                    offset = length;
+                    return true;
+                }
+            }
+
+            const std::size_t size = buffer.size();
+            buffer.resize( size + wanted );
+            buffer.resize( size + std::fread( &buffer[size], 1, wanted, file ) );
+        }
+
+        begin  = buffer.data();
+        end    = begin + buffer.size();
+        offset = buffer.size();
+        return !buffer.empty();
+    }
+
+    // just after the first newline at or after pos, or limit:
+    static char const * line_end( char const * const begin, char const * const pos, char const * const limit )
+    {
+        if ( pos == begin )
+        {
+            return pos;
+        }
+
+        char const * const eol = static_cast<char const *>( memchr( pos - 1, '\n', limit - pos + 1 ) );
+        return eol ? eol + 1 : limit;
+    }
+
+    std::FILE * file = nullptr;
+    char const * mapped = nullptr;
+    std::size_t size = 0;
+    std::size_t offset = 0;
+    std::string buffer;
+};
+
+/*
+ * convert a batch on the given number of threads, each a part of whole
+ * lines into its own output, and write the outputs in order.
+ */
+bool convert( converter const & conv, char const * const begin, char const * const end, std::vector<std::string> & outputs, std::FILE * const out )
+{
+    const std::size_t parts = outputs.size();
+
+    if ( 1 == parts )
+    {
+        outputs[0].clear();
+        conv.convert( begin, end, outputs[0] );
+    }
+    else
+    {
+        std::vector<std::thread> workers;
+        char const * pos = begin;
+
+        for ( std::size_t i = 0; i < parts; ++i )
+        {
+            char const * stop = i + 1 == parts ? end : (std::max)( pos, begin + ( end - begin ) * ( i + 1 ) / parts );
+
+            if ( stop != end && stop != pos )
+            {
+                char const * const eol = static_cast<char const *>( memchr( stop - 1, '\n', end - stop + 1 ) );
+                stop = eol ? eol + 1 : end;
+            }
+
+            outputs[i].clear();
+            workers.emplace_back( [&conv, pos, stop, &output = outputs[i]] { conv.convert( pos, stop, output ); } );
+            pos = stop;
+        }
+
+        for ( std::thread & worker : workers )
+        {
+            worker.join();
+        }
+    }
+
+    for ( std::string const & output : outputs )
+    {
+        if ( output.size() != std::fwrite( output.data(), 1, output.size(), out ) )
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+/*
+ * a list of fields, such as 2,4-6 or -3 or 5-, as selection by field number.
+ */
+bool read_fields( char const * text, std::vector<bool> & fields )
+{
+    const std::size_t most = 4096;
+
+    do
+    {
+        char * end;
+        std::size_t first = 1, last = most;
+
+        if ( '-' != *text )
+        {
+            first = std::strtoul( text, &end, 10 );
+            if ( end == text || 0 == first ) return false;
+            last = first;
+            text = end;
+        }
+
+        if ( '-' == *text )
+        {
+            ++text;
+            last = most;
+            if ( is_digit( *text ) )
+            {
+                last = std::strtoul( text, &end, 10 );
+                text = end;
+            }
+        }
+
+        if ( last < first || first >= most ) return false;
+
+        fields.resize( (std::max)( fields.size(), (std::min)( last, most - 1 ) + 1 ) );
+        std::fill( fields.begin() + first, fields.begin() + (std::min)( last, most - 1 ) + 1, true );
+    }
+    while ( ',' == *text++ );
+
+    return '\0' == text[-1];
+}
+
+int fail( char const * const message, char const * const detail = "" )
+{
+    std::fprintf( stderr, "engfmt: %s%s\n", message, detail );
+    return 2;
+}
+
+} // anonymous namespace
+
+int main( int argc, char * argv[] )
+{
+    options opt;
+    std::vector<char const *> files;
+
+    for ( int i = 1; i < argc; ++i )
+    {
+        std::string const arg = argv[i];
+
+        auto value = [&]() -> char const *
+        {
+            return i + 1 < argc ? argv[ ++i ] : nullptr;
+        };
+
+        if      ( "-h" == arg || "--help"        == arg ) { std::fputs( usage, stdout ); return 0; }
+        else if ( "-r" == arg || "--from-eng"    == arg ) { opt.from_eng    = true; }
+        else if ( "-e" == arg || "--exponential" == arg ) { opt.exponential = true; }
+        else if ( "-b" == arg || "--binary"      == arg ) { opt.binary      = true; }
+        else if ( "-d" == arg || "--digits"      == arg )
+        {
+            char const * const v = value();
+            if ( !v || ( opt.digits = std::atoi( v ) ) < 1 ) return fail( "expect digits of 1 or more" );
+        }
+        else if ( "-u" == arg || "--unit"        == arg )
+        {
+            char const * const v = value();
+            if ( !v ) return fail( "expect a unit" );
+            opt.unit = v;
+        }
+        else if ( "-s" == arg || "--separator"   == arg )
+        {
+            char const * const v = value();
+            if ( !v ) return fail( "expect a separator" );
+            opt.separator = v;
+        }
+        else if ( "-f" == arg || "--field"       == arg )
+        {
+            char const * const v = value();
+            if ( !v || !read_fields( v, opt.fields ) ) return fail( "expect fields such as 2,4-6, not ", v ? v : "nothing" );
+        }
+        else if ( "-t" == arg || "--delimiter"   == arg )
+        {
+            char const * const v = value();
+            if ( !v || strlen( v ) != 1 ) return fail( "expect a single-character delimiter" );
+            opt.delimiter = v[0];
+        }
+        else if ( "-j" == arg || "--threads"     == arg )
+        {
+            char const * const v = value();
+            if ( !v || !is_digit( v[0] ) ) return fail( "expect a number of threads" );
+            opt.threads = static_cast<unsigned>( std::strtoul( v, nullptr, 10 ) );
+        }
+        else if ( arg.size() > 1 && '-' == arg[0] )
+        {
+            return fail( "unknown option ", arg.c_str() );
+        }
+        else
+        {
+            files.push_back( argv[i] );
+        }
+    }
+
+    if ( 0 == opt.threads )
+    {
+        opt.threads = (std::max)( std::thread::hardware_concurrency(), 1u );
+    }
+
+    if ( files.empty() )
+    {
+        files.push_back( "-" );
+    }
+
+    const converter conv( opt );
+    std::vector<std::string> outputs( opt.threads );
+    int status = 0;
+
+    for ( char const * const name : files )
+    {
+        source input( name );
+
+        if ( !input.good() )
+        {
+            std::fprintf( stderr, "engfmt: %s: %s\n", name, std::strerror( errno ) );
+            status = 1;
+            continue;
+        }
+
+        char const * begin;
+        char const * end;
+
+        while ( input.next( batch_size * opt.threads, begin, end ) )
+        {
+            if ( !convert( conv, begin, end, outputs, stdout ) )
+            {
+                std::fprintf( stderr, "engfmt: write error: %s\n", std::strerror( errno ) );
+                return 1;
+            }
+        }
+
+        if ( input.failed() )
+        {
+            std::fprintf( stderr, "engfmt: %s: read error\n", name );
+            status = 1;
+        }
+    }
+
+    if ( 0 != std::fflush( stdout ) )
+    {
+        std::fprintf( stderr, "engfmt: write error: %s\n", std::strerror( errno ) );
+        return 1;
+    }
+
+    return status;
+}
+
+// end of file
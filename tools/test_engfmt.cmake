@@ -0,0 +1,64 @@
+# Copyright (C) 2013 by Martin Moene
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in
+# all copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+# THE SOFTWARE.
+
+# Run engfmt on a small text, to and from engineering notation, on one and
+# on several threads:
+#
+#   cmake -DENGFMT=path/to/engfmt -P test_engfmt.cmake
+
+set( input "${CMAKE_CURRENT_BINARY_DIR}/engfmt_input.txt" )
+
+function( expect name input_text expected )
+    file( WRITE ${input} "${input_text}" )
+    execute_process( COMMAND ${ENGFMT} ${ARGN} ${input} OUTPUT_VARIABLE output RESULT_VARIABLE result )
+    if ( NOT result EQUAL 0 OR NOT output STREQUAL expected )
+        message( SEND_ERROR "${name}: expected '${expected}', got '${output}' (status ${result})" )
+    endif()
+endfunction()
+
+expect( "all numbers"
+    "size 1234567 bytes in 2.5e4 s; v1.2.3 0x1f a5 -4700\n"
+    "size 1.23 M bytes in 25.0 k s; v1.2.3 0x1f a5 -4.70 k\n" )
+
+expect( "fields"
+    "id,value,name\n3,4700,7\n4,0.047,8\n"
+    "id,value,name\n3,4.7 k,7\n4,47 m,8\n" -f 2 -t , -d 2 )
+
+expect( "unit, separator and threads"
+    "1000\n2000000\n3\n"
+    "1.00_kB\n2.00_MB\n3.00_B\n" -u B -s _ -j 3 )
+
+expect( "binary prefixes"
+    "1536 bytes\n"
+    "1.50 Ki bytes\n" -b )
+
+expect( "from engineering notation"
+    "1.2k, -0.0470e3 k and 2.50 MB; 4 MiB; 3 a day\n"
+    "1200, -47 k and 2.5 MB; 4 MiB; 3 a day\n" -r )
+
+expect( "from engineering notation, with unit"
+    "4.7 mF 5 F 1.5kF\n"
+    "0.0047 F 5 F 1500 F\n" -r -u F )
+
+expect( "from engineering notation, fields"
+    "a,1.5 k,2 Mi\n"
+    "a,1500,2097152\n" -r -f 2- -t , )
+
+# end of file